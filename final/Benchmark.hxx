@@ -0,0 +1,118 @@
+#pragma once
+#include <chrono>
+#include <numeric>
+#include "RayMarching.hxx"
+#include "FastMath.hxx"
+#include "Noise.hxx"
+#include <glm/gtc/noise.hpp>
+
+namespace Benchmark {
+	template<typename PolicyType>
+	auto MeasureIntersectionThroughput(auto&& DistanceFunction, auto&& EyePoint, auto&& RayCaster, std::integral auto Height, std::integral auto Width) {
+		struct ObjectRecord {
+			field(DistanceFunction, std::function<auto(const typename PolicyType::Vector&)->typename PolicyType::Accumulator>{});
+			field(Material, 0);
+			field(IlluminationModel, 0);
+			field(LipschitzBound, 1.);
+			field(AnalyticIntersection, std::function<auto(const glm::vec4&, const glm::vec4&)->double>{});
+			field(LightLinks, DistanceField::LightLinks{});
+		};
+		auto ObjectRecords = std::vector<ObjectRecord>{ { .DistanceFunction = DistanceFunction } };
+		auto DistanceField = DistanceField::Synthesize<PolicyType>(ObjectRecords);
+		auto [Hits, StartTime] = std::tuple{ 0_z, std::chrono::steady_clock::now() };
+		for (auto y : Range{ Height })
+			for (auto x : Range{ Width })
+				if (auto [TraveledDistance, _, __] = Ray::Intersect(DistanceField, EyePoint, RayCaster(y, x)); TraveledDistance != Ray::NoIntersection)
+					++Hits;
+		auto ElapsedTime = std::chrono::duration<double>{ std::chrono::steady_clock::now() - StartTime }.count();
+		return std::tuple{ Height * Width / ElapsedTime, Hits };
+	}
+	auto ComparePrecisionPolicies(auto&& DistanceFunction, auto&& EyePoint, auto&& RayCaster, std::integral auto Height, std::integral auto Width) {
+		return std::array{
+			std::tuple{ "float"sv, MeasureIntersectionThroughput<Precision::Single>(DistanceFunction, EyePoint, RayCaster, Height, Width) },
+			std::tuple{ "float/double"sv, MeasureIntersectionThroughput<Precision::Mixed>(DistanceFunction, EyePoint, RayCaster, Height, Width) },
+			std::tuple{ "double"sv, MeasureIntersectionThroughput<Precision::Double>(DistanceFunction, EyePoint, RayCaster, Height, Width) }
+		};
+	}
+	auto MeasureKernelThroughput(auto&& Kernel, auto&& Samples, std::integral auto Repetitions) {
+		auto [Checksum, StartTime] = std::tuple{ 0., std::chrono::steady_clock::now() };
+		for (auto _ : Range{ Repetitions })
+			for (auto& x : Samples)
+				Checksum += std::apply(Kernel, x);
+		auto ElapsedTime = std::chrono::duration<double>{ std::chrono::steady_clock::now() - StartTime }.count();
+		auto volatile Sink = Checksum;
+		return std::tuple{ Repetitions * Samples.size() / ElapsedTime, static_cast<double>(Sink) };
+	}
+	// Kernel is called on Width samples at a time, each argument gathered into Lanes.
+	template<std::size_t Width>
+	auto MeasureBatchThroughput(auto&& Kernel, auto&& Samples, std::integral auto Repetitions) {
+		auto Batches = std::vector<decltype(std::apply([](auto... x) { return std::tuple{ FastMath::Lanes<decltype(x), Width>{ x }... }; }, Samples[0]))>(Samples.size() / Width);
+		for (auto Index : Range{ Batches.size() * Width })
+			std::apply([&](auto&... Batch) { std::apply([&](auto... x) { ((Batch[Index % Width] = x), ...); }, Samples[Index]); }, Batches[Index / Width]);
+		auto [Throughput, Checksum] = MeasureKernelThroughput([&](auto&&... x) {
+			auto Result = Kernel(x...);
+			return std::accumulate(Result.begin(), Result.end(), 0.);
+			}, Batches, Repetitions);
+		return std::tuple{ Throughput * Width, Checksum };
+	}
+	auto CompareFastMath(std::integral auto SampleCount, std::integral auto Repetitions) {
+		auto Sweep = [&](auto&& Parameterizer) {
+			auto Samples = std::vector<decltype(Parameterizer(0.))>{};
+			for (auto x : Range{ SampleCount })
+				Samples.push_back(Parameterizer((x + 0.5) / SampleCount));
+			return Samples;
+		};
+		auto Compare = [&](auto Name, auto&& Approximation, auto&& Reference, auto&& Samples) {
+			auto [MaximumAbsoluteError, MaximumRelativeError] = std::tuple{ 0., 0. };
+			for (auto& x : Samples) {
+				auto [Approximated, Exact] = std::tuple{ static_cast<double>(std::apply(Approximation, x)), std::apply([&](auto... x) { return Reference(static_cast<double>(x)...); }, x) };
+				MaximumAbsoluteError = std::max(MaximumAbsoluteError, std::abs(Approximated - Exact));
+				MaximumRelativeError = std::max(MaximumRelativeError, std::abs(Approximated - Exact) / std::max(std::abs(Exact), std::numeric_limits<double>::min()));
+			}
+			auto [ApproximationThroughput, _] = MeasureKernelThroughput(Approximation, Samples, Repetitions);
+			auto [ReferenceThroughput, __] = MeasureKernelThroughput(Reference, Samples, Repetitions);
+			auto [ApproximationBatchThroughput, ___] = MeasureBatchThroughput<8>(Approximation, Samples, Repetitions);
+			auto [ReferenceBatchThroughput, ____] = MeasureBatchThroughput<8>([&](auto&&... x) { return FastMath::ForEachLane(Reference, x...); }, Samples, Repetitions);
+			return std::tuple{ Name, MaximumAbsoluteError, MaximumRelativeError, ApproximationThroughput, ReferenceThroughput, ApproximationBatchThroughput, ReferenceBatchThroughput };
+		};
+		auto Over = [](auto Lower, auto Upper) {
+			return [=](auto t) { return std::tuple{ static_cast<float>(Lower + t * (Upper - Lower)) }; };
+		};
+		return std::array{
+			Compare("exp"sv, [](auto x) { return FastMath::Exp(x); }, [](auto x) { return std::exp(x); }, Sweep(Over(-87., 88.))),
+			Compare("log"sv, [](auto x) { return FastMath::Log(x); }, [](auto x) { return std::log(x); }, Sweep(Over(1e-3, 1e3))),
+			Compare("pow"sv, [](auto x, auto y) { return FastMath::Pow(x, y); }, [](auto x, auto y) { return std::pow(x, y); }, Sweep([](auto t) { return std::tuple{ static_cast<float>(1e-2 + t * (4 - 1e-2)), 16.f }; })),
+			Compare("sin"sv, [](auto x) { return FastMath::Sin(x); }, [](auto x) { return std::sin(x); }, Sweep(Over(-1e3, 1e3))),
+			Compare("cos"sv, [](auto x) { return FastMath::Cos(x); }, [](auto x) { return std::cos(x); }, Sweep(Over(-1e3, 1e3))),
+			Compare("acos"sv, [](auto x) { return FastMath::Acos(x); }, [](auto x) { return std::acos(x); }, Sweep(Over(-1., 1.))),
+			Compare("atan2"sv, [](auto y, auto x) { return FastMath::Atan2(y, x); }, [](auto y, auto x) { return std::atan2(y, x); }, Sweep([](auto t) {
+				auto Angle = std::numbers::pi * (2 * t - 1);
+				return std::tuple{ static_cast<float>((1 + 9 * t) * std::sin(Angle)), static_cast<float>((1 + 9 * t) * std::cos(Angle)) };
+			}))
+		};
+	}
+	auto CompareGradientNoise(const GradientNoise::Fractal& Parameters, std::integral auto SampleCount, std::integral auto Repetitions) {
+		auto Samples = std::vector<std::tuple<float, float>>{};
+		for (auto x : Range{ SampleCount })
+			Samples.push_back({ static_cast<float>(x % 1024) / 8, static_cast<float>(x / 1024) / 8 });
+		auto Reference = [&](auto x, auto y) {
+			auto [Sum, Normalization, Amplitude, Frequency] = std::tuple{ 0.f, 0.f, 1.f, static_cast<float>(Parameters.Frequency) };
+			for (auto _ : Range{ Parameters.Octaves }) {
+				Sum += Amplitude * glm::perlin(Frequency * glm::vec2{ x, y });
+				Normalization += Amplitude;
+				Amplitude *= static_cast<float>(Parameters.Gain);
+				Frequency *= static_cast<float>(Parameters.Lacunarity);
+			}
+			return Sum / Normalization;
+		};
+		auto Tabulated = [&](auto x, auto y) { return GradientNoise::FractalSum(Parameters, x, y); };
+		auto Mismatches = std::count_if(Samples.begin(), Samples.end(), [&](auto& x) { return std::apply(Reference, x) != std::apply(Tabulated, x); });
+		return std::tuple{
+			Mismatches,
+			std::get<0>(MeasureKernelThroughput(Reference, Samples, Repetitions)),
+			std::get<0>(MeasureKernelThroughput(Tabulated, Samples, Repetitions)),
+			std::get<0>(MeasureBatchThroughput<8>(Tabulated, Samples, Repetitions)),
+			std::get<0>(MeasureBatchThroughput<16>(Tabulated, Samples, Repetitions))
+		};
+	}
+}
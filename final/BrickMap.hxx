@@ -0,0 +1,242 @@
+#pragma once
+#include <fstream>
+#include <filesystem>
+#include <optional>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "RayMarching.hxx"
+
+// A sparse brick map samples a distance function over a box: a coarse lattice everywhere, refined
+// into bricks of finer samples in the cells the surface passes through. Lookups interpolate
+// trilinearly and subtract the largest error interpolation can hide for a field with the given
+// Lipschitz bound, so a baked distance never exceeds the exact one and is always safe to step by.
+// The file format is the in-memory layout, so cached maps are used straight from a read-only mapping.
+namespace DistanceField {
+	struct BakingParameters {
+		field(BoundingBox, std::tuple{ glm::vec4{ -1, -1, -1, 1 }, glm::vec4{ 1, 1, 1, 1 } });
+		field(Resolution, 32);
+		field(BrickResolution, 8);
+		field(LipschitzBound, 1.);
+		field(EnclosesSurface, false);
+	};
+
+	auto BrickMapCacheDirectory = std::filesystem::temp_directory_path() / "brickmaps";
+
+	auto Fingerprint(auto&&... Parameters) {
+		auto Hash = std::uint64_t{ 14695981039346656037ull };
+		auto Absorb = [&](const void* Data, std::size_t Size) {
+			for (auto Byte : Range{ Size })
+				Hash = (Hash ^ static_cast<const unsigned char*>(Data)[Byte]) * 1099511628211ull;
+		};
+		auto AbsorbParameter = [&](auto&& x) {
+			if constexpr (std::is_convertible_v<decltype(x), std::string_view>) {
+				auto Text = std::string_view{ x };
+				Absorb(Text.data(), Text.size());
+			}
+			else
+				Absorb(&x, sizeof(x));
+		};
+		(AbsorbParameter(Parameters), ...);
+		return Hash;
+	}
+}
+
+namespace DistanceField::ImplementationDetail {
+	struct BrickMapHeader {
+		field(Signature, (std::array<char, 8>{ 'B', 'R', 'I', 'C', 'K', 'M', 'A', 'P' }));
+		field(Version, std::uint32_t{ 1 });
+		field(Resolution, std::int32_t{ 0 });
+		field(Key, std::uint64_t{ 0 });
+		field(Origin, (std::array<float, 3>{}));
+		field(CellSize, 0.f);
+		field(BrickResolution, std::int32_t{ 0 });
+		field(BrickCount, std::int32_t{ 0 });
+		field(LipschitzBound, 0.f);
+		field(EnclosesSurface, std::int32_t{ 0 });
+	};
+
+	auto LatticeSize(auto Resolution) {
+		return static_cast<std::size_t>(Resolution + 1) * (Resolution + 1) * (Resolution + 1);
+	}
+	auto BrickMapSize(const BrickMapHeader& Header) {
+		auto CellCount = static_cast<std::size_t>(Header.Resolution) * Header.Resolution * Header.Resolution;
+		return sizeof(BrickMapHeader) + sizeof(float) * LatticeSize(Header.Resolution) + sizeof(std::int32_t) * CellCount + sizeof(float) * Header.BrickCount * LatticeSize(Header.BrickResolution);
+	}
+	using Utility::Concurrency::ForEachInParallel;
+}
+
+namespace DistanceField {
+	struct BrickMap {
+		field(Storage, std::shared_ptr<const std::byte>{});
+		field(Header, ImplementationDetail::BrickMapHeader{});
+		field(Lattice, static_cast<const float*>(nullptr));
+		field(BrickIndices, static_cast<const std::int32_t*>(nullptr));
+		field(Bricks, static_cast<const float*>(nullptr));
+
+	public:
+		BrickMap() = default;
+		BrickMap(std::shared_ptr<const std::byte> Storage) : Storage{ std::move(Storage) } {
+			std::memcpy(&Header, this->Storage.get(), sizeof(Header));
+			auto CellCount = static_cast<std::size_t>(Header.Resolution) * Header.Resolution * Header.Resolution;
+			Lattice = reinterpret_cast<const float*>(this->Storage.get() + sizeof(Header));
+			BrickIndices = reinterpret_cast<const std::int32_t*>(Lattice + ImplementationDetail::LatticeSize(Header.Resolution));
+			Bricks = reinterpret_cast<const float*>(BrickIndices + CellCount);
+		}
+		// The interpolated distance at the point of the box nearest to Position, the largest error the
+		// interpolation can hide there, and the distance from Position to the box.
+		auto Interpolate(auto&& Position) const {
+			auto UnclampedPosition = (glm::vec3{ Position } - glm::vec3{ Header.Origin[0], Header.Origin[1], Header.Origin[2] }) / Header.CellSize;
+			auto LatticePosition = glm::clamp(UnclampedPosition, glm::vec3{ 0 }, glm::vec3{ static_cast<float>(Header.Resolution) });
+			auto DistanceToBox = Header.CellSize * glm::length(UnclampedPosition - LatticePosition);
+			auto Cell = glm::min(glm::ivec3{ LatticePosition }, glm::ivec3{ Header.Resolution - 1 });
+			auto [Samples, Width, Spacing] = std::tuple{ Lattice, Header.Resolution, Header.CellSize };
+			if (auto Brick = BrickIndices[(Cell.z * Header.Resolution + Cell.y) * Header.Resolution + Cell.x]; Brick >= 0) {
+				LatticePosition = (LatticePosition - glm::vec3{ Cell }) * static_cast<float>(Header.BrickResolution);
+				Cell = glm::min(glm::ivec3{ LatticePosition }, glm::ivec3{ Header.BrickResolution - 1 });
+				Samples = Bricks + Brick * ImplementationDetail::LatticeSize(Header.BrickResolution);
+				Width = Header.BrickResolution;
+				Spacing /= Header.BrickResolution;
+			}
+			auto t = LatticePosition - glm::vec3{ Cell };
+			auto Sample = [&](auto x, auto y, auto z) { return Samples[((Cell.z + z) * (Width + 1) + Cell.y + y) * (Width + 1) + Cell.x + x]; };
+			auto Bottom = glm::mix(glm::mix(Sample(0, 0, 0), Sample(1, 0, 0), t.x), glm::mix(Sample(0, 1, 0), Sample(1, 1, 0), t.x), t.y);
+			auto Top = glm::mix(glm::mix(Sample(0, 0, 1), Sample(1, 0, 1), t.x), glm::mix(Sample(0, 1, 1), Sample(1, 1, 1), t.x), t.y);
+			auto InterpolationError = Header.LipschitzBound * Spacing * std::sqrt(glm::dot(t, 1.f - t));
+			return std::tuple{ glm::mix(Bottom, Top, t.z), InterpolationError, DistanceToBox };
+		}
+		// A lower bound on the baked function at Position. Outside the box it is extrapolated from the
+		// nearest point of the box, and also bounded by the distance to the box if that encloses the surface.
+		auto operator()(auto&& Position) const {
+			auto [Distance, InterpolationError, DistanceToBox] = Interpolate(Position);
+			auto LowerBound = Distance - InterpolationError - Header.LipschitzBound * DistanceToBox;
+			return Header.EnclosesSurface ? std::max(LowerBound, DistanceToBox) : LowerBound;
+		}
+		auto VoxelSize() const {
+			return static_cast<double>(Header.CellSize) / Header.BrickResolution;
+		}
+	};
+
+	auto BakeBrickMap(auto&& DistanceFunction, const BakingParameters& Parameters, std::uint64_t Key) {
+		using namespace ImplementationDetail;
+		auto& [LowerCorner, UpperCorner] = Parameters.BoundingBox;
+		auto Extent = glm::vec3{ UpperCorner - LowerCorner };
+		auto Header = BrickMapHeader{
+			.Resolution = Parameters.Resolution,
+			.Key = Key,
+			.Origin = { LowerCorner.x, LowerCorner.y, LowerCorner.z },
+			.CellSize = std::max({ Extent.x, Extent.y, Extent.z }) / Parameters.Resolution,
+			.BrickResolution = Parameters.BrickResolution,
+			.LipschitzBound = static_cast<float>(Parameters.LipschitzBound),
+			.EnclosesSurface = Parameters.EnclosesSurface
+		};
+		auto Evaluate = [&](auto&& Position) {
+			Footprint = 0;
+			return static_cast<float>(DistanceFunction(glm::dvec4{ glm::dvec3{ Header.Origin[0], Header.Origin[1], Header.Origin[2] } + glm::dvec3{ Position }, LowerCorner.w }));
+		};
+		auto [Resolution, BrickResolution] = std::tuple{ Parameters.Resolution, Parameters.BrickResolution };
+		auto Lattice = std::vector<float>(LatticeSize(Resolution));
+		ForEachInParallel(Resolution + 1, [&](auto z) {
+			for (auto y : Range{ Resolution + 1 })
+				for (auto x : Range{ Resolution + 1 })
+					Lattice[(z * (Resolution + 1) + y) * (Resolution + 1) + x] = Evaluate(glm::dvec3{ x, y, z } * static_cast<double>(Header.CellSize));
+		});
+		auto [BrickIndices, BrickedCells] = std::tuple{ std::vector<std::int32_t>(static_cast<std::size_t>(Resolution) * Resolution * Resolution, -1), std::vector<glm::ivec3>{} };
+		auto NarrowBand = Header.LipschitzBound * Header.CellSize * std::sqrt(3.f);
+		for (auto z : Range{ Resolution })
+			for (auto y : Range{ Resolution })
+				for (auto x : Range{ Resolution }) {
+					auto NearestCorner = std::numeric_limits<float>::infinity();
+					for (auto Corner : Range{ 8 })
+						NearestCorner = std::min(NearestCorner, std::abs(Lattice[((z + Corner / 4) * (Resolution + 1) + y + Corner / 2 % 2) * (Resolution + 1) + x + Corner % 2]));
+					if (NearestCorner <= NarrowBand) {
+						BrickIndices[(z * Resolution + y) * Resolution + x] = static_cast<std::int32_t>(BrickedCells.size());
+						BrickedCells.push_back({ x, y, z });
+					}
+				}
+		Header.BrickCount = static_cast<std::int32_t>(BrickedCells.size());
+		auto Buffer = std::make_shared<std::vector<std::byte>>(BrickMapSize(Header));
+		auto Bricks = reinterpret_cast<float*>(Buffer->data() + sizeof(Header) + sizeof(float) * Lattice.size() + sizeof(std::int32_t) * BrickIndices.size());
+		ForEachInParallel(BrickedCells.size(), [&](auto Brick) {
+			auto Samples = Bricks + Brick * LatticeSize(BrickResolution);
+			for (auto z : Range{ BrickResolution + 1 })
+				for (auto y : Range{ BrickResolution + 1 })
+					for (auto x : Range{ BrickResolution + 1 })
+						Samples[(z * (BrickResolution + 1) + y) * (BrickResolution + 1) + x] = Evaluate((glm::dvec3{ BrickedCells[Brick] } + glm::dvec3{ x, y, z } / static_cast<double>(BrickResolution)) * static_cast<double>(Header.CellSize));
+		});
+		std::memcpy(Buffer->data(), &Header, sizeof(Header));
+		std::memcpy(Buffer->data() + sizeof(Header), Lattice.data(), sizeof(float) * Lattice.size());
+		std::memcpy(Buffer->data() + sizeof(Header) + sizeof(float) * Lattice.size(), BrickIndices.data(), sizeof(std::int32_t) * BrickIndices.size());
+		return BrickMap{ std::shared_ptr<const std::byte>{ Buffer, Buffer->data() } };
+	}
+	auto LoadBrickMap(const std::filesystem::path& Path, std::uint64_t Key) -> std::optional<BrickMap> {
+		auto Descriptor = ::open(Path.c_str(), O_RDONLY);
+		if (Descriptor < 0)
+			return std::nullopt;
+		struct stat Status {};
+		auto Size = ::fstat(Descriptor, &Status) == 0 ? static_cast<std::size_t>(Status.st_size) : 0;
+		auto Mapping = Size >= sizeof(ImplementationDetail::BrickMapHeader) ? ::mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, Descriptor, 0) : MAP_FAILED;
+		::close(Descriptor);
+		if (Mapping == MAP_FAILED)
+			return std::nullopt;
+		auto Storage = std::shared_ptr<const std::byte>{ static_cast<const std::byte*>(Mapping), [=](auto) { ::munmap(Mapping, Size); } };
+		auto Header = ImplementationDetail::BrickMapHeader{};
+		std::memcpy(&Header, Storage.get(), sizeof(Header));
+		if (Header.Signature != ImplementationDetail::BrickMapHeader{}.Signature || Header.Version != ImplementationDetail::BrickMapHeader{}.Version || Header.Key != Key || ImplementationDetail::BrickMapSize(Header) != Size)
+			return std::nullopt;
+		return BrickMap{ std::move(Storage) };
+	}
+	auto SaveBrickMap(const std::filesystem::path& Path, const BrickMap& Map) {
+		auto ErrorCode = std::error_code{};
+		std::filesystem::create_directories(Path.parent_path(), ErrorCode);
+		auto TemporaryPath = std::filesystem::path{ Path }.concat(".partial");
+		if (auto File = std::ofstream{ TemporaryPath, std::ios::binary }; File.write(reinterpret_cast<const char*>(Map.Storage.get()), ImplementationDetail::BrickMapSize(Map.Header)))
+			File.close(), std::filesystem::rename(TemporaryPath, Path, ErrorCode);
+		else
+			std::filesystem::remove(TemporaryPath, ErrorCode);
+	}
+
+	template<typename DistanceFunctionType>
+	struct BakedField {
+		DistanceFunctionType DistanceFunction;
+		field(Map, BrickMap{});
+		field(ExactBand, 0.);
+
+	public:
+		auto operator()(auto&& Position) const {
+			using ResultType = decltype(DistanceFunction(Position));
+			auto Distance = [&] {
+				if (AcceptsLowerBounds)
+					return Map(Position);
+				auto [Estimate, _, DistanceToBox] = Map.Interpolate(Position);
+				if (DistanceToBox > 0)
+					return Map.Header.EnclosesSurface ? Estimate + DistanceToBox : 0.f;
+				return Estimate;
+			}();
+			if (Distance > std::max(ExactBand, 2 * Footprint))
+				return static_cast<ResultType>(Distance);
+			return DistanceFunction(Position);
+		}
+	};
+
+	// Replaces the exact function by its brick map wherever the baked distance stays clear of the surface;
+	// within a couple of voxels of it, or wherever the bound is too loose, the exact function takes over.
+	// Marchers get the conservative bound; fields that ask for estimates get the plain interpolation
+	// inside the box, extended by the distance to the box outside it if that encloses the surface, and
+	// the exact function otherwise. Maps are cached on disk under
+	// BrickMapCacheDirectory, keyed by Key together with the baking parameters, so Key must identify
+	// every parameter of the distance function itself.
+	auto Bake(auto&& DistanceFunction, const BakingParameters& Parameters, std::uint64_t Key) {
+		auto& [LowerCorner, UpperCorner] = Parameters.BoundingBox;
+		Key = Fingerprint(Key, LowerCorner, UpperCorner, Parameters.Resolution, Parameters.BrickResolution, Parameters.LipschitzBound, Parameters.EnclosesSurface);
+		auto Path = BrickMapCacheDirectory / (std::to_string(Key) + ".brickmap");
+		auto Map = LoadBrickMap(Path, Key);
+		if (!Map) {
+			Map = BakeBrickMap(DistanceFunction, Parameters, Key);
+			SaveBrickMap(Path, *Map);
+		}
+		auto ExactBand = 2 * Parameters.LipschitzBound * Map->VoxelSize();
+		return BakedField<std::decay_t<decltype(DistanceFunction)>>{ Forward(DistanceFunction), std::move(*Map), ExactBand };
+	}
+}
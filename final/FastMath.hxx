@@ -0,0 +1,187 @@
+#pragma once
+#include <bit>
+#include "Infrastructure.hxx"
+
+// Approximations of the transcendental functions used by the distance functions. Every kernel
+// is a straight-line polynomial after range reduction, written with selects in place of branches.
+// The lane-wise std::array overloads run the scalar kernel once per lane; GCC turns the clamps and
+// selects back into branches and so leaves those loops scalar even with -mavx2, and a batch only
+// saves call overhead. The coefficients target single precision whatever the argument type; double
+// arguments get float accuracy at double cost, which is why the double-precision fields keep using
+// libm by default.
+// The error bounds below were measured by Benchmark::CompareFastMath over the stated domains.
+namespace FastMath::ImplementationDetail {
+	template<typename ScalarType>
+	using BitsOf = std::conditional_t<sizeof(ScalarType) == 4, std::int32_t, std::int64_t>;
+	template<typename ScalarType>
+	constexpr auto MantissaWidth = std::numeric_limits<ScalarType>::digits - 1;
+	template<typename ScalarType>
+	constexpr auto ExponentBias = std::numeric_limits<ScalarType>::max_exponent - 1;
+
+	auto ScaleByPowerOfTwo(std::floating_point auto x, auto Exponent) {
+		using ScalarType = decltype(x);
+		using IntegerType = BitsOf<ScalarType>;
+		return x * std::bit_cast<ScalarType>(static_cast<IntegerType>(static_cast<IntegerType>(Exponent) + ExponentBias<ScalarType>) << MantissaWidth<ScalarType>);
+	}
+	auto RoundToNearest(std::floating_point auto x) {
+		constexpr auto Shifter = static_cast<decltype(x)>(3ll << (MantissaWidth<decltype(x)> - 1));
+		return (x + Shifter) - Shifter;
+	}
+	auto Polynomial(auto, auto Coefficient) {
+		return Coefficient;
+	}
+	auto Polynomial(auto x, auto Coefficient, auto... Coefficients) {
+		return Coefficient + x * Polynomial(x, Coefficients...);
+	}
+	auto ArcSineOfReducedArgument(auto x) {
+		using ScalarType = decltype(x);
+		auto z = x * x;
+		return x + x * z * Polynomial(z, ScalarType{ 1.6666752422e-1 }, ScalarType{ 7.4953002686e-2 }, ScalarType{ 4.5470025998e-2 }, ScalarType{ 2.4181311049e-2 }, ScalarType{ 4.2163199048e-2 });
+	}
+	auto ArcTangentOfReducedArgument(auto x) {
+		using ScalarType = decltype(x);
+		auto z = x * x;
+		return x + x * z * Polynomial(z, ScalarType{ -3.33329491539e-1 }, ScalarType{ 1.99777106478e-1 }, ScalarType{ -1.38776856032e-1 }, ScalarType{ 8.05374449538e-2 });
+	}
+}
+
+namespace FastMath {
+	// Relative error below 1e-7 on [-87, 88]; arguments outside are clamped to that range.
+	auto Exp(std::floating_point auto x) {
+		using ScalarType = decltype(x);
+		x = std::clamp(x, ScalarType{ -87 }, ScalarType{ 88 });
+		auto n = ImplementationDetail::RoundToNearest(x * std::numbers::log2e_v<ScalarType>);
+		auto r = x - n * ScalarType{ 0.693359375 } + n * ScalarType{ 2.12194440e-4 };
+		auto p = ImplementationDetail::Polynomial(r, ScalarType{ 5.0000001201e-1 }, ScalarType{ 1.6666665459e-1 }, ScalarType{ 4.1665795894e-2 }, ScalarType{ 8.3334519073e-3 }, ScalarType{ 1.3981999507e-3 }, ScalarType{ 1.9875691500e-4 });
+		return ImplementationDetail::ScaleByPowerOfTwo(p * r * r + r + 1, n);
+	}
+	// Absolute error below 4e-7 for normal positive arguments; zero, negative and denormal arguments are not handled.
+	auto Log(std::floating_point auto x) {
+		using ScalarType = decltype(x);
+		using IntegerType = ImplementationDetail::BitsOf<ScalarType>;
+		constexpr auto MantissaWidth = ImplementationDetail::MantissaWidth<ScalarType>;
+		constexpr auto ExponentBias = ImplementationDetail::ExponentBias<ScalarType>;
+		auto Bits = std::bit_cast<IntegerType>(x);
+		auto Exponent = static_cast<ScalarType>((Bits >> MantissaWidth) - ExponentBias);
+		auto Mantissa = std::bit_cast<ScalarType>((Bits & ((IntegerType{ 1 } << MantissaWidth) - 1)) | (static_cast<IntegerType>(ExponentBias) << MantissaWidth));
+		auto IsAboveSquareRootOf2 = Mantissa > std::numbers::sqrt2_v<ScalarType>;
+		Mantissa = IsAboveSquareRootOf2 ? Mantissa / 2 : Mantissa;
+		Exponent = IsAboveSquareRootOf2 ? Exponent + 1 : Exponent;
+		auto s = (Mantissa - 1) / (Mantissa + 1);
+		auto z = s * s;
+		return Exponent * std::numbers::ln2_v<ScalarType> + 2 * s * ImplementationDetail::Polynomial(z, ScalarType{ 1 }, ScalarType{ 1. / 3 }, ScalarType{ 1. / 5 }, ScalarType{ 1. / 7 }, ScalarType{ 1. / 9 });
+	}
+	// x^y for x > 0 as Exp(y Log(x)); the relative error grows with |y Log(x)|, about 5e-6 for the Mandelbulb's r^16.
+	auto Pow(std::floating_point auto x, std::floating_point auto y) {
+		return Exp(y * Log(x));
+	}
+	// Both kernels: absolute error below 1e-7 for |x| < 1e3, degrading linearly with |x| beyond that.
+	auto SinCos(std::floating_point auto x) {
+		using ScalarType = decltype(x);
+		auto Quadrant = ImplementationDetail::RoundToNearest(x * (2 / std::numbers::pi_v<ScalarType>));
+		auto r = ((x - Quadrant * ScalarType{ 1.5703125 }) - Quadrant * ScalarType{ 4.837512969970703125e-4 }) - Quadrant * ScalarType{ 7.54978995489188216e-8 };
+		auto z = r * r;
+		auto s = r + r * z * ImplementationDetail::Polynomial(z, ScalarType{ -1. / 6 }, ScalarType{ 1. / 120 }, ScalarType{ -1. / 5040 }, ScalarType{ 1. / 362880 });
+		auto c = 1 + z * ImplementationDetail::Polynomial(z, ScalarType{ -1. / 2 }, ScalarType{ 1. / 24 }, ScalarType{ -1. / 720 }, ScalarType{ 1. / 40320 }, ScalarType{ -1. / 3628800 });
+		auto Index = static_cast<int>(static_cast<long long>(Quadrant) & 3);
+		auto [Sine, Cosine] = std::tuple{ Index & 1 ? c : s, Index & 1 ? s : c };
+		return std::tuple{ Index & 2 ? -Sine : Sine, (Index + 1) & 2 ? -Cosine : Cosine };
+	}
+	auto Sin(std::floating_point auto x) {
+		return std::get<0>(SinCos(x));
+	}
+	auto Cos(std::floating_point auto x) {
+		return std::get<1>(SinCos(x));
+	}
+	// Absolute error below 3e-7 on [-1, 1].
+	auto Acos(std::floating_point auto x) {
+		using ScalarType = decltype(x);
+		auto IsNearUnity = std::abs(x) > ScalarType{ 0.5 };
+		auto Reduced = IsNearUnity ? std::sqrt((1 - std::abs(x)) / 2) : x;
+		auto ArcSine = ImplementationDetail::ArcSineOfReducedArgument(Reduced);
+		auto NearUnity = x > 0 ? 2 * ArcSine : std::numbers::pi_v<ScalarType> - 2 * ArcSine;
+		return IsNearUnity ? NearUnity : std::numbers::pi_v<ScalarType> / 2 - ArcSine;
+	}
+	// Absolute error below 2e-7 everywhere.
+	auto Atan(std::floating_point auto x) {
+		using ScalarType = decltype(x);
+		auto Magnitude = std::abs(x);
+		auto [IsAboveTan3PiOver8, IsAboveTanPiOver8] = std::tuple{ Magnitude > ScalarType{ 2.414213562373095 }, Magnitude > ScalarType{ 0.4142135623730950 } };
+		auto Reduced = IsAboveTan3PiOver8 ? -1 / Magnitude : IsAboveTanPiOver8 ? (Magnitude - 1) / (Magnitude + 1) : Magnitude;
+		auto Offset = IsAboveTan3PiOver8 ? std::numbers::pi_v<ScalarType> / 2 : IsAboveTanPiOver8 ? std::numbers::pi_v<ScalarType> / 4 : ScalarType{ 0 };
+		auto Result = Offset + ImplementationDetail::ArcTangentOfReducedArgument(Reduced);
+		return x < 0 ? -Result : Result;
+	}
+	// Absolute error below 3e-7 everywhere except at the origin, where it returns 0.
+	auto Atan2(std::floating_point auto y, std::floating_point auto x) {
+		using ScalarType = decltype(y);
+		auto Result = Atan(x == 0 ? ScalarType{ 0 } : y / x);
+		auto Correction = x < 0 ? (y < 0 ? -std::numbers::pi_v<ScalarType> : std::numbers::pi_v<ScalarType>) : ScalarType{ 0 };
+		auto Vertical = y > 0 ? std::numbers::pi_v<ScalarType> / 2 : y < 0 ? -std::numbers::pi_v<ScalarType> / 2 : ScalarType{ 0 };
+		return x == 0 ? Vertical : Result + Correction;
+	}
+}
+
+namespace FastMath {
+	template<typename ScalarType, std::size_t Width>
+	using Lanes = std::array<ScalarType, Width>;
+
+	auto ForEachLane(auto&& Kernel, auto&& x, auto&&... Arguments) {
+		auto Result = std::decay_t<decltype(x)>{};
+		for (auto Lane : Range{ x.size() })
+			Result[Lane] = Kernel(x[Lane], Arguments[Lane]...);
+		return Result;
+	}
+	template<typename ScalarType, std::size_t Width>
+	auto Exp(const Lanes<ScalarType, Width>& x) {
+		return ForEachLane([](auto x) { return Exp(x); }, x);
+	}
+	template<typename ScalarType, std::size_t Width>
+	auto Log(const Lanes<ScalarType, Width>& x) {
+		return ForEachLane([](auto x) { return Log(x); }, x);
+	}
+	template<typename ScalarType, std::size_t Width>
+	auto Pow(const Lanes<ScalarType, Width>& x, const Lanes<ScalarType, Width>& y) {
+		return ForEachLane([](auto x, auto y) { return Pow(x, y); }, x, y);
+	}
+	template<typename ScalarType, std::size_t Width>
+	auto Sin(const Lanes<ScalarType, Width>& x) {
+		return ForEachLane([](auto x) { return Sin(x); }, x);
+	}
+	template<typename ScalarType, std::size_t Width>
+	auto Cos(const Lanes<ScalarType, Width>& x) {
+		return ForEachLane([](auto x) { return Cos(x); }, x);
+	}
+	template<typename ScalarType, std::size_t Width>
+	auto Acos(const Lanes<ScalarType, Width>& x) {
+		return ForEachLane([](auto x) { return Acos(x); }, x);
+	}
+	template<typename ScalarType, std::size_t Width>
+	auto Atan2(const Lanes<ScalarType, Width>& y, const Lanes<ScalarType, Width>& x) {
+		return ForEachLane([](auto y, auto x) { return Atan2(y, x); }, y, x);
+	}
+}
+
+namespace FastMath {
+	struct Exact {
+		static auto Exp(auto x) { return std::exp(x); }
+		static auto Log(auto x) { return std::log(x); }
+		static auto Pow(auto x, auto y) { return std::pow(x, y); }
+		static auto Sin(auto x) { return std::sin(x); }
+		static auto Cos(auto x) { return std::cos(x); }
+		static auto Acos(auto x) { return std::acos(x); }
+		static auto Atan2(auto y, auto x) { return std::atan2(y, x); }
+	};
+	struct Approximate {
+		static auto Exp(auto x) { return FastMath::Exp(x); }
+		static auto Log(auto x) { return FastMath::Log(x); }
+		static auto Pow(auto x, auto y) { return FastMath::Pow(x, y); }
+		static auto Sin(auto x) { return FastMath::Sin(x); }
+		static auto Cos(auto x) { return FastMath::Cos(x); }
+		static auto Acos(auto x) { return FastMath::Acos(x); }
+		static auto Atan2(auto y, auto x) { return FastMath::Atan2(y, x); }
+	};
+
+	template<typename... MathPolicyTypes>
+	using Select = std::tuple_element_t<0, std::tuple<MathPolicyTypes..., Exact>>;
+}
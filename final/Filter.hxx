@@ -117,4 +117,60 @@ namespace Filter {
 		std::nth_element(Samples.begin(), Samples.begin() + 4, Samples.end());
 		return Samples[4];
 	};
+	// An edge-avoiding à-trous wavelet filter for renders with few samples per pixel. Every iteration convolves with a 5 x 5
+	// B3-spline kernel whose taps lie twice as far apart as in the iteration before, so a few iterations cover a wide footprint
+	// at 25 taps per sample each. A tap is weighed down by how far its color lies from the center's, relative to ColorTolerance
+	// (halved in every iteration, as the noise left is), by the angle between their normals (their cosine is raised to the power 2^NormalSharpness) and by the relative difference of
+	// their depths, and dropped if it shows another object. Normals holds the normal of every sample in three planes, and Geometry
+	// its depth and the index of its object, negative where nothing was hit. Rows are filtered in parallel, and each tap sweeps
+	// a row of contiguous samples.
+	auto EdgeAvoidingWavelet(auto&& SourceFrame, auto&& Normals, auto&& Geometry, std::integral auto Iterations, Real auto ColorTolerance) {
+		constexpr auto Spline = std::array{ 1 / 16., 1 / 4., 3 / 8., 1 / 4., 1 / 16. };
+		constexpr auto NormalSharpness = 4;
+		constexpr auto RelativeDepthTolerance = 0.02;
+		auto [Height, Width] = std::tuple{ static_cast<std::ptrdiff_t>(SourceFrame[0].Height), static_cast<std::ptrdiff_t>(SourceFrame[0].Width) };
+		auto Row = [](auto&& Plane, auto y) { return Plane.Data + y * Plane.Stride; };
+		auto [Filtered, Scratch] = std::tuple{ Frame{ Height, Width, 3 }, Frame{ Height, Width, 3 } };
+		for (auto c : Range{ 3 })
+			for (auto y : Range{ Height })
+				std::copy_n(Row(SourceFrame[c], y), Width, Row(Filtered[c], y));
+		for (auto Iteration : Range{ Iterations }) {
+			auto Step = static_cast<std::ptrdiff_t>(1) << Iteration;
+			auto ColorScale = std::ldexp(1., 2 * static_cast<int>(Iteration)) / (ColorTolerance * ColorTolerance);
+			Utility::Concurrency::ForEachInParallel(Height, [&](auto y) {
+				thread_local auto Accumulators = std::vector<double>{};
+				Accumulators.assign(4 * Width, 0.);
+				auto [RedSums, GreenSums, BlueSums, TotalWeights] = std::tuple{ Accumulators.data(), Accumulators.data() + Width, Accumulators.data() + 2 * Width, Accumulators.data() + 3 * Width };
+				auto [Red, Green, Blue] = std::tuple{ Row(Filtered[0], y), Row(Filtered[1], y), Row(Filtered[2], y) };
+				auto [NormalX, NormalY, NormalZ, Depths, Objects] = std::tuple{ Row(Normals[0], y), Row(Normals[1], y), Row(Normals[2], y), Row(Geometry[0], y), Row(Geometry[1], y) };
+				for (auto ky : Range{ -2, 3 })
+					if (auto yTap = y + ky * Step; yTap >= 0 && yTap < Height)
+						for (auto kx : Range{ -2, 3 }) {
+							auto xOffset = kx * Step;
+							auto KernelWeight = Spline[ky + 2] * Spline[kx + 2];
+							auto [TapRed, TapGreen, TapBlue] = std::tuple{ Row(Filtered[0], yTap) + xOffset, Row(Filtered[1], yTap) + xOffset, Row(Filtered[2], yTap) + xOffset };
+							auto [TapNormalX, TapNormalY, TapNormalZ, TapDepths, TapObjects] = std::tuple{ Row(Normals[0], yTap) + xOffset, Row(Normals[1], yTap) + xOffset, Row(Normals[2], yTap) + xOffset, Row(Geometry[0], yTap) + xOffset, Row(Geometry[1], yTap) + xOffset };
+							for (auto x : Range{ std::max(0_z, -xOffset), std::min(Width, Width - xOffset) }) {
+								auto [ΔRed, ΔGreen, ΔBlue] = std::tuple{ TapRed[x] - Red[x], TapGreen[x] - Green[x], TapBlue[x] - Blue[x] };
+								auto NormalWeight = std::max(0., NormalX[x] * TapNormalX[x] + NormalY[x] * TapNormalY[x] + NormalZ[x] * TapNormalZ[x]);
+								for (auto _ : Range{ NormalSharpness })
+									NormalWeight *= NormalWeight;
+								auto Exponent = (ΔRed * ΔRed + ΔGreen * ΔGreen + ΔBlue * ΔBlue) * ColorScale + std::abs(TapDepths[x] - Depths[x]) / (RelativeDepthTolerance * Depths[x] + 1e-9);
+								auto Weight = (Objects[x] == TapObjects[x]) * KernelWeight * NormalWeight * std::exp(-Exponent);
+								RedSums[x] += Weight * TapRed[x];
+								GreenSums[x] += Weight * TapGreen[x];
+								BlueSums[x] += Weight * TapBlue[x];
+								TotalWeights[x] += Weight;
+							}
+						}
+				for (auto x : Range{ Width }) {
+					Row(Scratch[0], y)[x] = TotalWeights[x] > 0 ? RedSums[x] / TotalWeights[x] : Red[x];
+					Row(Scratch[1], y)[x] = TotalWeights[x] > 0 ? GreenSums[x] / TotalWeights[x] : Green[x];
+					Row(Scratch[2], y)[x] = TotalWeights[x] > 0 ? BlueSums[x] / TotalWeights[x] : Blue[x];
+				}
+			});
+			std::swap(Filtered, Scratch);
+		}
+		return Filtered.Finalize();
+	}
 }
\ No newline at end of file
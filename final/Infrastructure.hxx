@@ -21,6 +21,9 @@
 #include <cstddef>
 #include <cmath>
 #include <cstdlib>
+#include <atomic>
+#include <numeric>
+#include <QtConcurrent/qtconcurrentmap.h>
 
 #define field(FieldIdentifier, ...) std::decay_t<decltype(__VA_ARGS__)> FieldIdentifier = __VA_ARGS__
 #define Forward(...) std::forward<decltype(__VA_ARGS__)>(__VA_ARGS__)
@@ -256,4 +259,26 @@ namespace Utility::ContainerManipulators {
 		using TargetContainerType = Reflection::ContainerReplaceElementType<decltype(SourceContainer), TransformedElementType>;
 		return MapWithNaturalTransformation<TargetContainerType>(Forward(TransformationForEachElement), Forward(SourceContainer));
 	}
-}
\ No newline at end of file
+}
+
+namespace Utility::Concurrency {
+	// Calls Action(Index) for every Index below Count on the global QThreadPool the renders run on, and waits for all of them.
+	auto ForEachInParallel(std::integral auto Count, auto&& Action) {
+		auto Indices = std::vector<std::int64_t>(static_cast<std::size_t>(Count));
+		std::iota(Indices.begin(), Indices.end(), 0);
+		QtConcurrent::blockingMap(Indices, [&](std::int64_t Index) { Action(Index); });
+	}
+}
+namespace Utility::Hashing {
+	// The splitmix64 finalizer: scatters every bit of x over the whole result.
+	constexpr auto Mix(std::uint64_t x) {
+		x = (x ^ x >> 30) * 0xBF58476D1CE4E5B9_u64;
+		x = (x ^ x >> 27) * 0x94D049BB133111EB_u64;
+		return x ^ x >> 31;
+	}
+
+	// A number in [0, 1) drawn from the upper bits of a hash.
+	constexpr auto Uniform(std::uint64_t Hash) {
+		return static_cast<double>(Hash >> 11) * 0x1p-53;
+	}
+}
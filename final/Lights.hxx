@@ -0,0 +1,216 @@
+#pragma once
+#include <bit>
+#include <span>
+#include "Ray.hxx"
+
+// Light lists for illumination models with many lights. Lights are split by type once, when the model is
+// configured: directional lights reach everything, while a point light only reaches as far as its
+// attenuation function keeps it above LightInfluenceThreshold, and the spheres it reaches are kept in a
+// bounding volume hierarchy. Shading a point then walks the hierarchy for the few point lights around
+// it instead of every light in the scene. With StochasticLightSamples set, a point takes only that many
+// of the lights that reach it, drawn by their unshadowed brightness and weighted by the inverse of
+// their probability, so the cost of shading stops growing with the number of lights.
+// Spot lights shine from pos along dir. angle is the half-angle of their cone and penumbra the width of the
+// band inside its edge over which they fade out, both in degrees, and radius is the radius of the disk
+// they shine from. Area lights are width x height rectangles centred at pos that shine towards dir. Both
+// cast soft shadows whose penumbrae follow from the size of the emitter, see MeasureEmitter.
+namespace Illuminations {
+	auto LightInfluenceThreshold = 1. / 512;
+	auto StochasticLightSamples = 0;
+
+	// The brightness of a light at a distance, before shading and shadows.
+	auto EstimateAttenuation(auto&& Light, double LightDistance) {
+		return std::min(1 / (Light.function.x + Light.function.y * LightDistance + Light.function.z * LightDistance * LightDistance), 1.);
+	}
+
+	// The distance past which the attenuated brightest channel of a point light stays under LightInfluenceThreshold,
+	// or infinity if it never does.
+	auto EstimateInfluenceRadius(auto&& Light) {
+		auto [c, l, q] = std::tuple{ static_cast<double>(Light.function.x), static_cast<double>(Light.function.y), static_cast<double>(Light.function.z) };
+		auto Brightness = std::max({ static_cast<double>(Light.color.x), static_cast<double>(Light.color.y), static_cast<double>(Light.color.z) });
+		if (Brightness <= 0)
+			return 0.;
+		if (auto Reciprocal = Brightness / LightInfluenceThreshold; Reciprocal <= c)
+			return 0.;
+		else if (q > 0)
+			return (-l + std::sqrt(l * l + 4 * q * (Reciprocal - c))) / (2 * q);
+		else if (l > 0)
+			return (Reciprocal - c) / l;
+		else
+			return std::numeric_limits<double>::infinity();
+	}
+
+	// The normal of an area light or the axis of a spot light, and the axes along which its width and height run.
+	auto EmitterFrame(auto&& Light) {
+		auto Normal = glm::normalize(glm::vec3{ Light.dir });
+		auto Right = glm::normalize(glm::cross(std::abs(Normal.y) < 0.99f ? glm::vec3{ 0, 1, 0 } : glm::vec3{ 1, 0, 0 }, Normal));
+		return std::tuple{ Normal, Right, glm::cross(Normal, Right) };
+	}
+
+	// The point of a light nearest to SurfacePosition, which is where its light is taken to come from.
+	auto NearestEmitterPoint(auto&& Light, auto&& SurfacePosition) {
+		auto [Center, Position] = std::tuple{ glm::vec3{ Light.pos }, glm::vec3{ SurfacePosition } };
+		if (Light.type == LightType::LIGHT_AREA) {
+			auto [_, Right, Up] = EmitterFrame(Light);
+			auto Displacement = Position - Center;
+			Center += std::clamp(glm::dot(Displacement, Right), -Light.width / 2, Light.width / 2) * Right + std::clamp(glm::dot(Displacement, Up), -Light.height / 2, Light.height / 2) * Up;
+		}
+		return glm::vec4{ Center, SurfacePosition.w };
+	}
+
+	// How much of a light leaves it along LightDirection: spot lights fade out towards the edge of their cone, and area
+	// lights emit with the cosine of the angle to their normal.
+	auto EstimateEmission(auto&& Light, auto&& LightDirection) {
+		auto [Normal, _, __] = EmitterFrame(Light);
+		auto Cosine = glm::dot(Normal, glm::vec3{ LightDirection });
+		if (Light.type == LightType::LIGHT_SPOT) {
+			auto [Outer, Inner] = std::tuple{ std::cos(glm::radians(Light.angle)), std::cos(glm::radians(std::max(Light.angle - Light.penumbra, 0.f))) };
+			if (Cosine >= Inner)
+				return 1.f;
+			auto Falloff = std::clamp((Cosine - Outer) / std::max(Inner - Outer, std::numeric_limits<float>::min()), 0.f, 1.f);
+			return Falloff * Falloff * (3 - 2 * Falloff);
+		}
+		else if (Light.type == LightType::LIGHT_AREA)
+			return std::max(Cosine, 0.f);
+		return 1.f;
+	}
+
+	// The radius of the disk that a spot or area light looks like from SurfacePosition, and its distance. A shadow ray
+	// marched towards it with a hardness of that distance over that radius bounds the cone the disk subtends, so the
+	// penumbra trick of the occlusion estimate turns into the part of the emitter hidden from SurfacePosition.
+	auto MeasureEmitter(auto&& Light, auto&& SurfacePosition) {
+		auto EmitterDistance = static_cast<double>(glm::length(glm::vec3{ SurfacePosition } - glm::vec3{ NearestEmitterPoint(Light, SurfacePosition) }));
+		if (Light.type == LightType::LIGHT_AREA) {
+			auto Foreshortening = std::max(EstimateEmission(Light, glm::normalize(glm::vec3{ SurfacePosition } - glm::vec3{ Light.pos })), 0.f);
+			return std::tuple{ std::sqrt(static_cast<double>(Light.width) * Light.height * Foreshortening / std::numbers::pi), EmitterDistance };
+		}
+		return std::tuple{ static_cast<double>(Light.radius), EmitterDistance };
+	}
+
+	struct LightHierarchy {
+		struct LocalLight {
+			field(Position, glm::vec3{});
+			field(SquaredRadius, 0.f);
+			field(LightIndex, 0_uz);
+		};
+		struct Node {
+			field(LowerCorner, glm::vec3{});
+			field(UpperCorner, glm::vec3{});
+			field(First, 0_uz);
+			field(Count, 0_uz);
+			field(SecondChild, 0_uz);
+		};
+
+		static constexpr auto LeafSize = 4_uz;
+		static constexpr auto MaximumDepth = 64;
+
+		field(GlobalLights, std::vector<std::size_t>{});
+		field(LocalLights, std::vector<LocalLight>{});
+		field(Nodes, std::vector<Node>{});
+
+	private:
+		auto Subdivide(std::size_t First, std::size_t Count) -> std::size_t {
+			auto NodeIndex = Nodes.size();
+			auto [LowerCorner, UpperCorner] = std::tuple{ glm::vec3{ std::numeric_limits<float>::infinity() }, glm::vec3{ -std::numeric_limits<float>::infinity() } };
+			auto [LowerCenter, UpperCenter] = std::tuple{ LowerCorner, UpperCorner };
+			for (auto& [Position, SquaredRadius, _] : std::span{ LocalLights }.subspan(First, Count)) {
+				auto Radius = std::sqrt(SquaredRadius);
+				std::tie(LowerCorner, UpperCorner) = std::tuple{ glm::min(LowerCorner, Position - Radius), glm::max(UpperCorner, Position + Radius) };
+				std::tie(LowerCenter, UpperCenter) = std::tuple{ glm::min(LowerCenter, Position), glm::max(UpperCenter, Position) };
+			}
+			Nodes.push_back({ .LowerCorner = LowerCorner, .UpperCorner = UpperCorner, .First = First, .Count = Count });
+			if (Count <= LeafSize)
+				return NodeIndex;
+			auto Extent = UpperCenter - LowerCenter;
+			auto Axis = Extent.x >= Extent.y && Extent.x >= Extent.z ? 0 : Extent.y >= Extent.z ? 1 : 2;
+			auto Middle = LocalLights.begin() + First + Count / 2;
+			std::nth_element(LocalLights.begin() + First, Middle, LocalLights.begin() + First + Count, [&](auto& x, auto& y) { return x.Position[Axis] < y.Position[Axis]; });
+			Nodes[NodeIndex].Count = 0;
+			Subdivide(First, Count / 2);
+			auto SecondChild = Subdivide(First + Count / 2, Count - Count / 2);
+			Nodes[NodeIndex].SecondChild = SecondChild;
+			return NodeIndex;
+		}
+
+	public:
+		static auto Build(auto& Lights) {
+			auto Hierarchy = LightHierarchy{};
+			for (auto LightIndex : Range{ Lights.size() })
+				if (auto& Light = Lights[LightIndex]; Light.type == LightType::LIGHT_DIRECTIONAL)
+					Hierarchy.GlobalLights.push_back(LightIndex);
+				else if (Light.type == LightType::LIGHT_POINT || Light.type == LightType::LIGHT_SPOT || Light.type == LightType::LIGHT_AREA) {
+					auto Extent = Light.type == LightType::LIGHT_AREA ? std::hypot(Light.width, Light.height) / 2 : 0.;
+					if (auto Radius = EstimateInfluenceRadius(Light); std::isinf(Radius))
+						Hierarchy.GlobalLights.push_back(LightIndex);
+					else if (Radius > 0)
+						Hierarchy.LocalLights.push_back({ .Position = glm::vec3{ Light.pos }, .SquaredRadius = static_cast<float>((Radius + Extent) * (Radius + Extent)), .LightIndex = static_cast<std::size_t>(LightIndex) });
+				}
+				else
+					throw std::runtime_error{ "Unrecognized light type detected!" };
+			if (Hierarchy.LocalLights.empty() == false)
+				Hierarchy.Subdivide(0, Hierarchy.LocalLights.size());
+			return Hierarchy;
+		}
+
+		// Appends the index of every light that reaches Position to Indices, in no particular order.
+		auto Gather(auto&& Position, std::vector<std::size_t>& Indices) const {
+			Indices.insert(Indices.end(), GlobalLights.begin(), GlobalLights.end());
+			if (Nodes.empty())
+				return;
+			auto Point = glm::vec3{ Position };
+			auto [PendingNodes, PendingNodeCount] = std::tuple{ std::array<std::size_t, MaximumDepth>{}, 1_uz };
+			while (PendingNodeCount > 0) {
+				auto NodeIndex = PendingNodes[--PendingNodeCount];
+				auto& [LowerCorner, UpperCorner, First, Count, SecondChild] = Nodes[NodeIndex];
+				if (glm::any(glm::lessThan(Point, LowerCorner)) || glm::any(glm::greaterThan(Point, UpperCorner)))
+					continue;
+				if (Count > 0) {
+					for (auto& [LightPosition, SquaredRadius, LightIndex] : std::span{ LocalLights }.subspan(First, Count))
+						if (auto Displacement = Point - LightPosition; glm::dot(Displacement, Displacement) <= SquaredRadius)
+							Indices.push_back(LightIndex);
+					continue;
+				}
+				PendingNodes[PendingNodeCount++] = SecondChild;
+				PendingNodes[PendingNodeCount++] = NodeIndex + 1;
+			}
+		}
+	};
+
+	// Fills Samples with StochasticLightSamples of the lights in Indices, drawn by their unshadowed brightness at
+	// SurfacePosition and paired with the weights that keep their sum unbiased, or with every light in Indices at a
+	// weight of 1 if there are not more of them than that. Draws at the same surface point are repeatable.
+	auto SampleLights(auto& Lights, auto&& SurfacePosition, const std::vector<std::size_t>& Indices, std::vector<std::tuple<std::size_t, float>>& Samples) {
+		Samples.clear();
+		if (StochasticLightSamples <= 0 || Indices.size() <= static_cast<std::size_t>(StochasticLightSamples)) {
+			for (auto LightIndex : Indices)
+				Samples.push_back({ LightIndex, 1.f });
+			return;
+		}
+		thread_local auto CumulativeImportance = std::vector<double>{};
+		CumulativeImportance.clear();
+		for (auto TotalImportance = 0.; auto LightIndex : Indices) {
+			auto& Light = Lights[LightIndex];
+			auto Brightness = std::max({ static_cast<double>(Light.color.x), static_cast<double>(Light.color.y), static_cast<double>(Light.color.z) });
+			if (Light.type != LightType::LIGHT_DIRECTIONAL)
+				Brightness *= EstimateAttenuation(Light, glm::length(glm::vec3{ SurfacePosition } - glm::vec3{ NearestEmitterPoint(Light, SurfacePosition) }));
+			CumulativeImportance.push_back(TotalImportance += Brightness);
+		}
+		if (CumulativeImportance.back() <= 0)
+			return;
+		auto Seed = Utility::Hashing::Mix(std::bit_cast<std::uint32_t>(SurfacePosition.x) ^ Utility::Hashing::Mix(std::bit_cast<std::uint32_t>(SurfacePosition.y) ^ Utility::Hashing::Mix(std::bit_cast<std::uint32_t>(SurfacePosition.z))));
+		for (auto SampleIndex : Range{ StochasticLightSamples }) {
+			auto Target = Utility::Hashing::Uniform(Utility::Hashing::Mix(Seed + static_cast<std::uint64_t>(SampleIndex))) * CumulativeImportance.back();
+			auto Selection = static_cast<std::size_t>(std::upper_bound(CumulativeImportance.begin(), CumulativeImportance.end() - 1, Target) - CumulativeImportance.begin());
+			auto Probability = (CumulativeImportance[Selection] - (Selection > 0 ? CumulativeImportance[Selection - 1] : 0.)) / CumulativeImportance.back();
+			Samples.push_back({ Indices[Selection], static_cast<float>(1 / (StochasticLightSamples * Probability)) });
+		}
+		std::sort(Samples.begin(), Samples.end());
+		auto Merged = Samples.begin();
+		for (auto x = Samples.begin(); x != Samples.end(); ++x)
+			if (Merged != Samples.begin() && std::get<0>(Merged[-1]) == std::get<0>(*x))
+				std::get<1>(Merged[-1]) += std::get<1>(*x);
+			else
+				*Merged++ = *x;
+		Samples.erase(Merged, Samples.end());
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "RayMarching.hxx"
+#include "FastMath.hxx"
+
+// Classic 2D gradient noise, lattice-for-lattice identical to glm::perlin: the permutation
+// polynomial and the gradient construction are evaluated once per scalar type into tables,
+// so a sample costs four table lookups instead of two rounds of mod-289 hashing.
+namespace GradientNoise::ImplementationDetail {
+	constexpr auto Period = 289;
+
+	template<typename ScalarType>
+	auto Permute(ScalarType x) {
+		auto y = (x * ScalarType{ 34 } + 1) * x;
+		return y - std::floor(y / Period) * Period;
+	}
+	template<typename ScalarType>
+	auto BuildPermutationTable() {
+		auto Table = std::array<int, Period>{};
+		for (auto x : Range{ Period })
+			Table[x] = static_cast<int>(Permute(static_cast<ScalarType>(x)));
+		return Table;
+	}
+	template<typename ScalarType>
+	auto BuildGradientTable() {
+		auto Table = std::array<Precision::Vector2<ScalarType>, 2 * Period>{};
+		for (auto x : Range{ 2 * Period }) {
+			auto Hash = Permute(static_cast<ScalarType>(x));
+			auto g = ScalarType{ 2 } * glm::fract(Hash / ScalarType{ 41 }) - 1;
+			auto Gradient = Precision::Vector2<ScalarType>{ g - std::floor(g + static_cast<ScalarType>(0.5)), std::abs(g) - static_cast<ScalarType>(0.5) };
+			Table[x] = Gradient * (static_cast<ScalarType>(1.79284291400159) - static_cast<ScalarType>(0.85373472095314) * glm::dot(Gradient, Gradient));
+		}
+		return Table;
+	}
+	template<typename ScalarType>
+	const auto PermutationTable = BuildPermutationTable<ScalarType>();
+	template<typename ScalarType>
+	const auto GradientTable = BuildGradientTable<ScalarType>();
+
+	auto Floor(std::floating_point auto x) {
+		auto Integer = static_cast<int>(x);
+		return Integer - (x < Integer);
+	}
+	auto Wrap(int x) {
+		return (x % Period + Period) % Period;
+	}
+	auto Fade(auto t) {
+		return t * t * t * (t * (t * 6 - 15) + 10);
+	}
+}
+
+namespace GradientNoise {
+	struct Fractal {
+		field(Octaves, 2);
+		field(Frequency, 0.5);
+		field(Lacunarity, 1.5);
+		field(Gain, 0.5);
+	};
+
+	template<std::floating_point ScalarType>
+	auto Perlin(ScalarType x, ScalarType y) {
+		using namespace ImplementationDetail;
+		auto [Permutation, Gradients] = std::tie(PermutationTable<ScalarType>, GradientTable<ScalarType>);
+		auto [xi, yi] = std::tuple{ Floor(x), Floor(y) };
+		auto [x0, y0] = std::tuple{ x - xi, y - yi };
+		auto [x1, y1] = std::tuple{ x0 - 1, y0 - 1 };
+		auto [Left, Right, Bottom, Top] = std::tuple{ Permutation[Wrap(xi)], Permutation[Wrap(xi + 1)], Wrap(yi), Wrap(yi + 1) };
+		auto n00 = glm::dot(Gradients[Left + Bottom], Precision::Vector2<ScalarType>{ x0, y0 });
+		auto n10 = glm::dot(Gradients[Right + Bottom], Precision::Vector2<ScalarType>{ x1, y0 });
+		auto n01 = glm::dot(Gradients[Left + Top], Precision::Vector2<ScalarType>{ x0, y1 });
+		auto n11 = glm::dot(Gradients[Right + Top], Precision::Vector2<ScalarType>{ x1, y1 });
+		auto [u, v] = std::tuple{ Fade(x0), Fade(y0) };
+		auto [Lower, Upper] = std::tuple{ n00 + u * (n10 - n00), n01 + u * (n11 - n01) };
+		return static_cast<ScalarType>(2.3) * (Lower + v * (Upper - Lower));
+	}
+	// Sum of Octaves layers of Perlin noise, normalized by the total amplitude so the range stays that of a single layer.
+	template<std::floating_point ScalarType>
+	auto FractalSum(const Fractal& Parameters, ScalarType x, ScalarType y) {
+		auto [Sum, Normalization] = std::tuple{ ScalarType{ 0 }, ScalarType{ 0 } };
+		auto [Amplitude, Frequency] = std::tuple{ ScalarType{ 1 }, static_cast<ScalarType>(Parameters.Frequency) };
+		for (auto _ : Range{ Parameters.Octaves }) {
+			Sum += Amplitude * Perlin(Frequency * x, Frequency * y);
+			Normalization += Amplitude;
+			Amplitude *= static_cast<ScalarType>(Parameters.Gain);
+			Frequency *= static_cast<ScalarType>(Parameters.Lacunarity);
+		}
+		return Sum / Normalization;
+	}
+
+	template<typename ScalarType, std::size_t Width>
+	auto Perlin(const FastMath::Lanes<ScalarType, Width>& x, const FastMath::Lanes<ScalarType, Width>& y) {
+		return FastMath::ForEachLane([](auto x, auto y) { return Perlin(x, y); }, x, y);
+	}
+	template<typename ScalarType, std::size_t Width>
+	auto FractalSum(const Fractal& Parameters, const FastMath::Lanes<ScalarType, Width>& x, const FastMath::Lanes<ScalarType, Width>& y) {
+		return FastMath::ForEachLane([&](auto x, auto y) { return FractalSum(Parameters, x, y); }, x, y);
+	}
+}
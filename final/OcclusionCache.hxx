@@ -0,0 +1,119 @@
+#pragma once
+#include <bit>
+#include "RayMarching.hxx"
+
+// A world-space cache of soft-shadow occlusion that all worker threads of a render share without locks.
+// Surface points are binned into a hashed grid keyed by the light, the dominant axis of the normal and a
+// cell whose power-of-two size is a few ray footprints wide, so the cell is the radius over which an
+// occlusion stays valid and distant surfaces share coarser cells. The grid is flattened along the
+// dominant axis of the normal, each cell averages the exact occlusions recorded in it, and a lookup
+// interpolates bilinearly between those of the four cells around a point that hold enough samples.
+// Cells ahead of the scanline are still empty, so a lookup answers once the filled cells carry
+// OcclusionCacheMinimumWeight of the interpolation weight, and only while they agree to within
+// OcclusionCacheTolerance: shadow edges keep being evaluated exactly, and only the smooth parts of
+// the shadows are shared between pixels and supersamples.
+namespace Illuminations {
+	auto OcclusionCacheCapacity = 1_uz << 20;
+	auto OcclusionCacheCellFootprints = 8.;
+	auto OcclusionCacheSmallestCell = 1e-3;
+	auto OcclusionCacheMinimumSamples = 4_u64;
+	auto OcclusionCacheMaximumSamples = 64_u64;
+	auto OcclusionCacheMinimumWeight = 0.5;
+	auto OcclusionCacheTolerance = 0.05;
+
+	struct OcclusionCache {
+		struct Slot {
+			field(Key, std::atomic<std::uint64_t>{ 0 });
+			field(Samples, std::atomic<std::uint64_t>{ 0 });
+		};
+
+		// A slot packs its sample count into the upper half of Samples and the sum of its samples, in units
+		// of 1 / SampleScale, into the lower half, so one atomic addition records a sample.
+		static constexpr auto CountUnit = 1_u64 << 32;
+		static constexpr auto SampleScale = 65535.;
+		static constexpr auto ProbeLength = 8;
+
+		field(Slots, std::unique_ptr<Slot[]>{});
+		field(Capacity, 0_uz);
+
+	private:
+		static auto KeyOf(std::size_t LightIndex, int Facing, int Level, const glm::ivec3& Cell) {
+			using Utility::Hashing::Mix;
+			auto Key = Mix(static_cast<std::uint64_t>(LightIndex) << 16 | static_cast<std::uint64_t>(Level + 128) << 3 | static_cast<std::uint64_t>(Facing));
+			for (auto Axis : Range{ 3 })
+				Key = Mix(Key ^ static_cast<std::uint32_t>(Cell[Axis]));
+			return std::max(Key, 1_u64);
+		}
+		auto Find(std::uint64_t Key, bool Inserts) const -> Slot* {
+			for (auto Index = Key & (Capacity - 1); auto _ : Range{ ProbeLength }) {
+				auto& x = Slots[Index];
+				auto Occupant = x.Key.load(std::memory_order_acquire);
+				if (Occupant == Key)
+					return &x;
+				if (Occupant == 0) {
+					if (Inserts == false)
+						return nullptr;
+					if (x.Key.compare_exchange_strong(Occupant, Key, std::memory_order_acq_rel) || Occupant == Key)
+						return &x;
+				}
+				Index = (Index + 1) & (Capacity - 1);
+			}
+			return nullptr;
+		}
+
+		// The dominant axis of the normal and its sign, the size level of the cells around a point shaded with the
+		// current footprint, and the point in units of those cells.
+		static auto Locate(const glm::vec4& SurfacePosition, const glm::vec4& SurfaceNormal) {
+			auto Magnitude = glm::abs(glm::vec3{ SurfaceNormal });
+			auto Axis = Magnitude.x >= Magnitude.y && Magnitude.x >= Magnitude.z ? 0 : Magnitude.y >= Magnitude.z ? 1 : 2;
+			auto Level = static_cast<int>(std::ceil(std::log2(std::max(OcclusionCacheSmallestCell, OcclusionCacheCellFootprints * DistanceField::Footprint))));
+			auto Position = glm::dvec3{ SurfacePosition } / std::ldexp(1., Level);
+			return std::tuple{ Axis, 2 * Axis + (SurfaceNormal[Axis] < 0), Level, Position };
+		}
+
+	public:
+		auto Record(std::size_t LightIndex, const glm::vec4& SurfacePosition, const glm::vec4& SurfaceNormal, double Occlusion) const {
+			auto [_, Facing, Level, Position] = Locate(SurfacePosition, SurfaceNormal);
+			if (auto x = Find(KeyOf(LightIndex, Facing, Level, glm::ivec3{ glm::floor(Position) }), true); x != nullptr && x->Samples.load(std::memory_order_relaxed) / CountUnit < OcclusionCacheMaximumSamples)
+				x->Samples.fetch_add(CountUnit + static_cast<std::uint64_t>(std::lround(std::clamp(Occlusion, 0., 1.) * SampleScale)), std::memory_order_relaxed);
+		}
+		auto LookUp(std::size_t LightIndex, const glm::vec4& SurfacePosition, const glm::vec4& SurfaceNormal) const -> std::optional<double> {
+			auto [Axis, Facing, Level, Position] = Locate(SurfacePosition, SurfaceNormal);
+			auto [u, v] = std::tuple{ (Axis + 1) % 3, (Axis + 2) % 3 };
+			auto Cell = glm::ivec3{ glm::floor(Position) };
+			auto [CellU, CellV] = std::tuple{ static_cast<int>(std::floor(Position[u] - 0.5)), static_cast<int>(std::floor(Position[v] - 0.5)) };
+			auto [fu, fv] = std::tuple{ Position[u] - 0.5 - CellU, Position[v] - 0.5 - CellV };
+			auto [Interpolation, TotalWeight, Lowest, Highest] = std::tuple{ 0., 0., 1., 0. };
+			for (auto Corner : Range{ 4 }) {
+				std::tie(Cell[u], Cell[v]) = std::tuple{ CellU + static_cast<int>(Corner & 1), CellV + static_cast<int>(Corner >> 1) };
+				auto x = Find(KeyOf(LightIndex, Facing, Level, Cell), false);
+				if (x == nullptr)
+					continue;
+				auto Samples = x->Samples.load(std::memory_order_relaxed);
+				if (Samples / CountUnit < OcclusionCacheMinimumSamples)
+					continue;
+				auto Occlusion = static_cast<double>(Samples % CountUnit) / SampleScale / static_cast<double>(Samples / CountUnit);
+				auto Weight = (Corner & 1 ? fu : 1 - fu) * (Corner >> 1 ? fv : 1 - fv);
+				std::tie(Lowest, Highest) = std::tuple{ std::min(Lowest, Occlusion), std::max(Highest, Occlusion) };
+				std::tie(Interpolation, TotalWeight) = std::tuple{ Interpolation + Weight * Occlusion, TotalWeight + Weight };
+			}
+			if (TotalWeight < OcclusionCacheMinimumWeight || Highest - Lowest > OcclusionCacheTolerance)
+				return std::nullopt;
+			return Interpolation / TotalWeight;
+		}
+	};
+
+	// A pair of LookUpOcclusion and RecordOcclusion hooks that share one empty cache of Capacity slots, rounded up to a power of two.
+	auto ConfigureOcclusionCache(std::size_t Capacity) {
+		auto Cache = std::make_shared<OcclusionCache>();
+		Cache->Capacity = std::bit_ceil(std::max(Capacity, 1_uz));
+		Cache->Slots = std::make_unique<OcclusionCache::Slot[]>(Cache->Capacity);
+		auto LookUp = [=](std::size_t LightIndex, const glm::vec4& SurfacePosition, const glm::vec4& SurfaceNormal) {
+			return Cache->LookUp(LightIndex, SurfacePosition, SurfaceNormal);
+		};
+		auto Record = [=](std::size_t LightIndex, const glm::vec4& SurfacePosition, const glm::vec4& SurfaceNormal, double Occlusion) {
+			Cache->Record(LightIndex, SurfacePosition, SurfaceNormal, Occlusion);
+		};
+		return std::tuple{ LookUp, Record };
+	}
+}
@@ -1,5 +1,7 @@
 ﻿#pragma once
+#include <optional>
 #include "Ray.hxx"
+#include "Lights.hxx"
 
 namespace ViewPlane {
 	auto ConfigureRayCaster(auto&& LookVector, auto&& UpVector, auto FocalLength, auto Height, auto Width) {
@@ -13,23 +15,207 @@ namespace ViewPlane {
 			return glm::vec4{ glm::normalize(NormalizedX * AspectRatio * xAxis + NormalizedY * yAxis + FocalLength * zAxis), 0 };
 		};
 	}
+	auto EstimatePixelConeAngle(auto FocalLength, auto Height) {
+		return 1. / (FocalLength * Height);
+	}
+}
+
+namespace Precision {
+	template<typename ScalarType>
+	using Vector2 = glm::detail::tvec2<ScalarType, glm::highp>;
+	template<typename ScalarType>
+	using Vector3 = glm::detail::tvec3<ScalarType, glm::highp>;
+	template<typename ScalarType>
+	using Vector4 = glm::detail::tvec4<ScalarType, glm::highp>;
+	template<typename ScalarType>
+	using Matrix2 = glm::detail::tmat2x2<ScalarType, glm::highp>;
+	template<typename ScalarType>
+	using Matrix4 = glm::detail::tmat4x4<ScalarType, glm::highp>;
+	template<typename ScalarType>
+	using Matrix4x3 = glm::detail::tmat4x3<ScalarType, glm::highp>;
+	template<typename PositionType>
+	using ScalarOf = typename std::decay_t<PositionType>::value_type;
+
+	template<typename ScalarType, typename AccumulatorType = ScalarType>
+	struct Policy {
+		using Scalar = ScalarType;
+		using Accumulator = AccumulatorType;
+		using Vector = Vector4<ScalarType>;
+
+	public:
+		static auto Advance(auto&& EyePoint, auto TraveledDistance, auto&& RayDirection) {
+			return Vector{ EyePoint } + static_cast<Scalar>(TraveledDistance) * Vector{ RayDirection };
+		}
+	};
+
+	using Single = Policy<float>;
+	using Double = Policy<double>;
+	using Mixed = Policy<float, double>;
+
+	namespace ImplementationDetail {
+		template<typename FieldType>
+		struct PolicyOf {
+			using Type = Mixed;
+		};
+		template<typename FieldType> requires requires { typename FieldType::PrecisionPolicy; }
+		struct PolicyOf<FieldType> {
+			using Type = typename FieldType::PrecisionPolicy;
+		};
+	}
+
+	template<typename FieldType>
+	using PolicyOf = typename ImplementationDetail::PolicyOf<std::decay_t<FieldType>>::Type;
 }
 
 namespace DistanceField {
-	auto Synthesize(auto& ObjectRecords) {
-		return [&](auto&& Position) {
-			using ObjectRecordType = std::decay_t<decltype(*std::begin(ObjectRecords))>;
-			auto NearestObjectRecord = std::tuple{ std::numeric_limits<double>::infinity(), static_cast<ObjectRecordType*>(nullptr) };
-			for (auto& [NearestDistance, _] = NearestObjectRecord; auto& x : ObjectRecords)
-				if (auto& [DistanceFunction, __, ___] = x; std::abs(DistanceFunction(Position)) < std::abs(NearestDistance))
-					NearestObjectRecord = std::tuple{ DistanceFunction(Position), const_cast<ObjectRecordType*>(&x) };
+	struct Payload {
+		field(OrbitTrap, std::numeric_limits<float>::infinity());
+		field(EscapeIteration, 0.f);
+		field(SubObject, 0);
+	};
+
+	constexpr auto AllLights = ~std::uint64_t{ 0 };
+	constexpr auto NoLights = std::uint64_t{ 0 };
+
+	// Which lights reach an object and which shadows it takes part in. Bit i of a light mask stands for
+	// the i-th light of the illumination model; lights past the 64th are linked to everything. On top of
+	// that, an object only shadows receivers whose ShadowedByGroups include one of its CasterGroups.
+	// Low-frequency surfaces may share the shadows of the lights in CachesShadowsFrom between nearby points.
+	struct LightLinks {
+		field(LitBy, AllLights);
+		field(CastsShadowsFrom, AllLights);
+		field(ReceivesShadowsFrom, AllLights);
+		field(CachesShadowsFrom, NoLights);
+		field(CasterGroups, std::uint64_t{ 1 });
+		field(ShadowedByGroups, ~std::uint64_t{ 0 });
+	};
+	constexpr auto Links(std::uint64_t LightMask, std::integral auto LightIndex) {
+		return LightIndex >= 64 || (LightMask >> LightIndex & 1) != 0;
+	}
+
+	thread_local auto Footprint = 0.;
+	thread_local auto Auxiliary = Payload{};
+	thread_local auto AcceptsLowerBounds = true;
+
+	template<typename PolicyType, typename ObjectRecordContainerType>
+	struct SynthesizedField {
+		using PrecisionPolicy = PolicyType;
+		field(ObjectRecords, static_cast<ObjectRecordContainerType*>(nullptr));
+		field(AppliesLipschitzBounds, true);
+		field(SkipsAnalyticObjects, false);
+		field(EstimatesDistances, false);
+		field(ShadowedLight, -1);
+		field(ShadowedGroups, ~std::uint64_t{ 0 });
+
+	public:
+		auto operator()(auto&& Position) const {
+			using ObjectRecordType = std::decay_t<decltype(*std::begin(*ObjectRecords))>;
+			auto ConvertedPosition = typename PolicyType::Vector{ Position };
+			auto NearestObjectRecord = std::tuple{ std::numeric_limits<typename PolicyType::Accumulator>::infinity(), static_cast<ObjectRecordType*>(nullptr), Payload{} };
+			auto EnclosingAcceptance = std::exchange(AcceptsLowerBounds, AcceptsLowerBounds && !EstimatesDistances);
+			for (auto& [NearestDistance, _, __] = NearestObjectRecord; auto& x : *ObjectRecords) {
+				auto& [DistanceFunction, ___, ____, LipschitzBound, AnalyticIntersection, ObjectLinks] = x;
+				if (SkipsAnalyticObjects && AnalyticIntersection)
+					continue;
+				if (ShadowedLight >= 0 && (!Links(ObjectLinks.CastsShadowsFrom, ShadowedLight) || (ObjectLinks.CasterGroups & ShadowedGroups) == 0))
+					continue;
+				Auxiliary = Payload{};
+				if (auto Distance = static_cast<typename PolicyType::Accumulator>(AppliesLipschitzBounds ? DistanceFunction(ConvertedPosition) / LipschitzBound : DistanceFunction(ConvertedPosition)); std::abs(Distance) < std::abs(NearestDistance))
+					NearestObjectRecord = std::tuple{ Distance, const_cast<ObjectRecordType*>(&x), Auxiliary };
+			}
+			AcceptsLowerBounds = EnclosingAcceptance;
 			return NearestObjectRecord;
-		};
+		}
+	};
+
+	template<typename PolicyType = Precision::Mixed>
+	auto Synthesize(auto& ObjectRecords) {
+		return SynthesizedField<PolicyType, std::remove_reference_t<decltype(ObjectRecords)>>{ .ObjectRecords = &ObjectRecords };
+	}
+
+	template<typename DistanceFunctionType>
+	struct TransformedField {
+		DistanceFunctionType DistanceFunction;
+		field(InverseTransform, Precision::Matrix4x3<double>{ 1 });
+		field(SinglePrecisionInverseTransform, Precision::Matrix4x3<float>{ 1 });
+		field(LipschitzScale, 1.);
+
+	public:
+		auto operator()(auto&& Position) const {
+			using Scalar = Precision::ScalarOf<decltype(Position)>;
+			auto& ConvertedInverseTransform = [&]() -> auto& {
+				if constexpr (std::is_same_v<Scalar, float>)
+					return SinglePrecisionInverseTransform;
+				else
+					return InverseTransform;
+			}();
+			auto LocalPosition = Precision::Vector4<Scalar>{ ConvertedInverseTransform * Precision::Vector4<Scalar>{ Position.x, Position.y, Position.z, 1 }, 0 };
+			auto WorldFootprint = std::exchange(Footprint, Footprint / LipschitzScale);
+			auto Distance = static_cast<Scalar>(LipschitzScale) * static_cast<Scalar>(DistanceFunction(LocalPosition));
+			Footprint = WorldFootprint;
+			return Distance;
+		}
+	};
+
+	auto Transform(auto&& DistanceFunction, auto&& Translation, auto&& Rotation, auto Scale) {
+		auto LocalToWorld = glm::translate(glm::dvec3{ Translation }) * glm::dmat4{ Rotation } * glm::scale(glm::dvec3{ static_cast<double>(Scale) });
+		if constexpr (requires { DistanceFunction.InverseTransform; }) {
+			auto InverseTransform = Precision::Matrix4x3<double>{ glm::dmat4{ DistanceFunction.InverseTransform } * glm::inverse(LocalToWorld) };
+			return TransformedField<std::decay_t<decltype(DistanceFunction.DistanceFunction)>>{ DistanceFunction.DistanceFunction, InverseTransform, Precision::Matrix4x3<float>{ InverseTransform }, Scale * DistanceFunction.LipschitzScale };
+		}
+		else {
+			auto InverseTransform = Precision::Matrix4x3<double>{ glm::inverse(LocalToWorld) };
+			return TransformedField<std::decay_t<decltype(DistanceFunction)>>{ Forward(DistanceFunction), InverseTransform, Precision::Matrix4x3<float>{ InverseTransform }, static_cast<double>(Scale) };
+		}
+	}
+	auto WithoutLipschitzBounds(auto DistanceField) {
+		if constexpr (requires { DistanceField.AppliesLipschitzBounds; })
+			DistanceField.AppliesLipschitzBounds = false;
+		return DistanceField;
+	}
+	auto WithDistanceEstimates(auto DistanceField) {
+		if constexpr (requires { DistanceField.EstimatesDistances; })
+			DistanceField.EstimatesDistances = true;
+		return DistanceField;
+	}
+	auto WithoutAnalyticObjects(auto DistanceField) {
+		if constexpr (requires { DistanceField.SkipsAnalyticObjects; })
+			DistanceField.SkipsAnalyticObjects = true;
+		return DistanceField;
 	}
+	// A view of the field that holds only the objects casting shadows from the given light onto receivers in ShadowedByGroups.
+	auto WithShadowCastersOf(auto DistanceField, int LightIndex, std::uint64_t ShadowedByGroups) {
+		if constexpr (requires { DistanceField.ShadowedLight; })
+			DistanceField.ShadowedLight = LightIndex, DistanceField.ShadowedGroups = ShadowedByGroups;
+		return DistanceField;
+	}
+	// Only samples farther than SurfaceClearance outside the surface count: the marcher never steps from inside, fractal estimators
+	// are meaningless inside their set, and right at their surface the escape count jumps between neighbouring taps.
+	auto EstimateLipschitzBound(auto&& DistanceFunction, auto&& BoundingBox, std::integral auto SamplesPerAxis, double SurfaceClearance = 0.) {
+		constexpr auto ε = 1e-3;
+		auto& [LowerCorner, UpperCorner] = BoundingBox;
+		auto [Extent, LipschitzBound] = std::tuple{ glm::dvec4{ UpperCorner - LowerCorner }, 0. };
+		auto Evaluate = [&](auto&& Position) { return static_cast<double>(DistanceFunction(Position)); };
+		for (auto z : Range{ SamplesPerAxis })
+			for (auto y : Range{ SamplesPerAxis })
+				for (auto x : Range{ SamplesPerAxis }) {
+					auto Position = glm::dvec4{ glm::dvec3{ LowerCorner } + glm::dvec3{ Extent } * glm::dvec3{ x + 0.5, y + 0.5, z + 0.5 } / static_cast<double>(SamplesPerAxis), 1 };
+					if (Evaluate(Position) <= std::max(ε, SurfaceClearance))
+						continue;
+					auto Gradient = glm::dvec3{
+						Evaluate(Position + glm::dvec4{ ε, 0, 0, 0 }) - Evaluate(Position - glm::dvec4{ ε, 0, 0, 0 }),
+						Evaluate(Position + glm::dvec4{ 0, ε, 0, 0 }) - Evaluate(Position - glm::dvec4{ 0, ε, 0, 0 }),
+						Evaluate(Position + glm::dvec4{ 0, 0, ε, 0 }) - Evaluate(Position - glm::dvec4{ 0, 0, ε, 0 }) } / (2 * ε);
+					LipschitzBound = std::max(LipschitzBound, glm::length(Gradient));
+				}
+		return LipschitzBound;
+	}
+	template<typename PolicyType = Precision::Mixed>
 	auto 𝛁(auto&& DistanceFunction, auto&& Position) {
-		constexpr auto ε = 1e-4;
-		auto [dx, dy, dz] = std::tuple{ glm::vec4{ ε, 0, 0, 0 }, glm::vec4{ 0, ε, 0, 0 }, glm::vec4{ 0, 0, ε, 0 } };
-		return glm::vec4{ glm::normalize(glm::vec3{ DistanceFunction(Position + dx) - DistanceFunction(Position - dx), DistanceFunction(Position + dy) - DistanceFunction(Position - dy), DistanceFunction(Position + dz) - DistanceFunction(Position - dz) }), 0 };
+		using VectorType = typename PolicyType::Vector;
+		constexpr auto ε = static_cast<typename PolicyType::Scalar>(1e-4);
+		auto [Center, dx, dy, dz] = std::tuple{ VectorType{ Position }, VectorType{ ε, 0, 0, 0 }, VectorType{ 0, ε, 0, 0 }, VectorType{ 0, 0, ε, 0 } };
+		return glm::vec4{ glm::normalize(glm::vec3{ DistanceFunction(Center + dx) - DistanceFunction(Center - dx), DistanceFunction(Center + dy) - DistanceFunction(Center - dy), DistanceFunction(Center + dz) - DistanceFunction(Center - dz) }), 0 };
 	}
 }
 
@@ -40,120 +226,689 @@ namespace Ray {
 	auto RecursiveMarchingDepth = 4;
 	auto RelativeStepSizeForIntersection = 1.;
 	auto RelativeStepSizeForOcclusionEstimation = 0.1;
+	auto MinimumPathThroughput = 1. / 256;
+	auto AmbientOcclusionTaps = 0;
+	auto AmbientOcclusionSpacing = 0.05;
+	auto AmbientOcclusionFalloff = 0.5;
+	auto PixelConeAngle = 0.;
+	constexpr auto Unbounded = std::numeric_limits<float>::infinity();
+	const auto UnboundedBox = std::tuple{ glm::vec4{ -Unbounded, -Unbounded, -Unbounded, 0 }, glm::vec4{ Unbounded, Unbounded, Unbounded, 0 } };
+	auto SceneBoundingBox = UnboundedBox;
+	auto EnvironmentShader = std::function<auto(const glm::vec4&, const glm::vec4&)->glm::vec4>{};
+
+	// How much cheaper than a primary ray a secondary ray may be traced: its hit threshold, step limit and the footprint
+	// fractals pick their detail from are scaled by these, and a surface it reaches is shaded without shadows when the
+	// throughput of its path falls below MinimumShadowedThroughput in every channel.
+	struct RayQuality {
+		field(HitThresholdScale, 1.);
+		field(StepLimitScale, 1.);
+		field(FootprintScale, 1.);
+		field(MinimumShadowedThroughput, 0.);
+	};
+	// The quality of rays that have bounced n times is entry n - 1, and the last entry holds for every deeper bounce;
+	// while this is empty, every ray is traced at full quality.
+	auto SecondaryRayQualities = std::vector<RayQuality>{};
+	// The quality of the ray being traced and of the shadows cast onto the surface it reaches.
+	thread_local auto ActiveRayQuality = RayQuality{};
 
-	auto Intersect(auto&& DistanceField, auto&& EyePoint, auto&& RayDirection) {
+	auto QualityOfRecursionDepth(std::integral auto RecursionDepth) {
+		if (RecursionDepth <= 1 || SecondaryRayQualities.empty())
+			return RayQuality{};
+		return SecondaryRayQualities[std::min(static_cast<std::size_t>(RecursionDepth - 2), SecondaryRayQualities.size() - 1)];
+	}
+
+	// The features of a scene that the marcher and its illumination models are compiled for. Whatever a scene is compiled
+	// without is never checked for at a hit, so it must not turn up later, e.g. set on a material by an interrupt handler.
+	struct SceneFeatures {
+		field(Reflection, true);
+		field(Refraction, true);
+		field(Shadows, true);
+		field(OnlyDirectionalLights, false);
+	};
+	constexpr auto AllFeatures = SceneFeatures{};
+
+	// The features ObjectRecords use as they are now, lit by Lights.
+	auto DetectFeatures(auto&& ObjectRecords, auto&& Lights) {
+		auto Features = SceneFeatures{ .Reflection = false, .Refraction = false, .Shadows = false, .OnlyDirectionalLights = true };
+		for (auto& [_, ObjectMaterial, __, ___, ____, ObjectLinks] : ObjectRecords) {
+			Features.Reflection = Features.Reflection || ObjectMaterial.IsReflective;
+			Features.Refraction = Features.Refraction || ObjectMaterial.IsTransparent;
+			Features.Shadows = Features.Shadows || ObjectLinks.ReceivesShadowsFrom != DistanceField::NoLights;
+		}
+		for (auto& Light : Lights)
+			Features.OnlyDirectionalLights = Features.OnlyDirectionalLights && Light.type == LightType::LIGHT_DIRECTIONAL;
+		return Features;
+	}
+
+	// Calls Action.template operator()<CompiledFeatures>() once, where CompiledFeatures matches Features in the given Fields and
+	// is AllFeatures in every other field, so a render picks its specialization once and only the Fields multiply instantiations.
+	template<auto... Fields> requires (sizeof...(Fields) > 0)
+	auto DispatchFeatures(SceneFeatures Features, auto&& Action) {
+		static constexpr auto Members = std::array{ Fields... };
+		constexpr auto Decode = [](std::size_t Code) {
+			auto DecodedFeatures = AllFeatures;
+			for (auto Index = 0_uz; Index < Members.size(); ++Index)
+				DecodedFeatures.*Members[Index] = (Code >> Index & 1) != 0;
+			return DecodedFeatures;
+		};
+		auto Code = 0_uz;
+		for (auto Index : Range{ Members.size() })
+			Code |= static_cast<std::size_t>(Features.*Members[Index]) << Index;
+		[&]<std::size_t... Codes>(std::index_sequence<Codes...>) {
+			((Code == Codes ? Action.template operator()<Decode(Codes)>() : void()), ...);
+		}(std::make_index_sequence<1_uz << Members.size()>{});
+	}
+
+	auto ClipToSceneBounds(auto&& EyePoint, auto&& RayDirection) {
+		auto& [Minimum, Maximum] = SceneBoundingBox;
+		auto [EntryDistance, ExitDistance] = std::tuple{ 0., FarthestMarchingDistance };
+		for (auto Axis : Range{ 3 }) {
+			auto NearPlaneDistance = (static_cast<double>(Minimum[Axis]) - EyePoint[Axis]) / RayDirection[Axis];
+			auto FarPlaneDistance = (static_cast<double>(Maximum[Axis]) - EyePoint[Axis]) / RayDirection[Axis];
+			EntryDistance = std::fmax(EntryDistance, std::fmin(NearPlaneDistance, FarPlaneDistance));
+			ExitDistance = std::fmin(ExitDistance, std::fmax(NearPlaneDistance, FarPlaneDistance));
+		}
+		return std::tuple{ EntryDistance, ExitDistance };
+	}
+	auto ShadeMiss(auto&& EyePoint, auto&& RayDirection) {
+		if (EnvironmentShader)
+			return EnvironmentShader(glm::vec4{ EyePoint }, RayDirection);
+		return glm::vec4{ 0, 0, 0, 0 };
+	}
+
+	auto Intersect(auto&& DistanceField, auto&& EyePoint, auto&& RayDirection, double ConeRadius = 0.) {
+		using PrecisionPolicy = Precision::PolicyOf<decltype(DistanceField)>;
 		using ObjectRecordPointerType = decltype([&] {
-			auto [_, PointerToObjectRecord] = DistanceField(EyePoint + 0.f * RayDirection);
+			auto [_, PointerToObjectRecord, __] = DistanceField(PrecisionPolicy::Advance(EyePoint, 0., RayDirection));
 			return PointerToObjectRecord;
 			}());
-		for (auto TraveledDistance = 1e-3; auto _ : Range{ MaximumMarchingSteps }) {
-			auto [UnboundingRadius, PointerToObjectRecord] = DistanceField(EyePoint + static_cast<float>(TraveledDistance) * RayDirection);
+		auto [EntryDistance, ExitDistance] = ClipToSceneBounds(EyePoint, RayDirection);
+		if (EntryDistance > ExitDistance)
+			return std::tuple{ NoIntersection, static_cast<ObjectRecordPointerType>(nullptr), DistanceField::Payload{} };
+		auto StartingDistance = std::max(1e-3, EntryDistance);
+		auto [AnalyticDistance, AnalyticObjectRecord] = std::tuple{ NoIntersection, static_cast<ObjectRecordPointerType>(nullptr) };
+		if constexpr (requires { DistanceField.SkipsAnalyticObjects; })
+			for (auto& x : *DistanceField.ObjectRecords)
+				if (auto& [_, __, ___, ____, AnalyticIntersection, _____] = x; AnalyticIntersection)
+					if (auto Distance = AnalyticIntersection(glm::vec4{ EyePoint } + static_cast<float>(StartingDistance) * RayDirection, RayDirection); Distance != NoIntersection && StartingDistance + Distance <= ExitDistance)
+						std::tie(AnalyticDistance, AnalyticObjectRecord, ExitDistance) = std::tuple{ StartingDistance + Distance, const_cast<ObjectRecordPointerType>(&x), StartingDistance + Distance };
+		auto AnalyticIntersectionRecord = std::tuple{ AnalyticDistance, AnalyticObjectRecord, DistanceField::Payload{} };
+		auto MarchedField = DistanceField::WithoutAnalyticObjects(DistanceField);
+		auto LargestUnboundingRadius = 0.;
+		for (auto TraveledDistance = static_cast<typename PrecisionPolicy::Accumulator>(StartingDistance); auto _ : Range{ static_cast<int>(MaximumMarchingSteps * ActiveRayQuality.StepLimitScale) }) {
+			auto Position = PrecisionPolicy::Advance(EyePoint, TraveledDistance, RayDirection);
+			auto FootprintRadius = ActiveRayQuality.FootprintScale * (ConeRadius + PixelConeAngle * TraveledDistance);
+			DistanceField::Footprint = FootprintRadius;
+			auto [UnboundingRadius, PointerToObjectRecord, SurfacePayload] = MarchedField(Position);
+			LargestUnboundingRadius = std::max<double>(LargestUnboundingRadius, UnboundingRadius);
+			auto HitThreshold = std::max(ActiveRayQuality.HitThresholdScale * IntersectionThreshold, std::min(FootprintRadius, LargestUnboundingRadius / 2));
 			TraveledDistance += RelativeStepSizeForIntersection * std::abs(UnboundingRadius);
-			if (0 <= UnboundingRadius && UnboundingRadius < IntersectionThreshold)
-				return std::tuple{ TraveledDistance, PointerToObjectRecord };
-			if (TraveledDistance > FarthestMarchingDistance)
-				return std::tuple{ NoIntersection, static_cast<ObjectRecordPointerType>(nullptr) };
+			if (0 <= UnboundingRadius && UnboundingRadius < HitThreshold)
+				return std::tuple{ static_cast<double>(TraveledDistance), PointerToObjectRecord, SurfacePayload };
+			if (TraveledDistance > ExitDistance)
+				return AnalyticIntersectionRecord;
 		}
-		return std::tuple{ NoIntersection, static_cast<ObjectRecordPointerType>(nullptr) };
+		return AnalyticIntersectionRecord;
 	}
-	auto EstimateOccludedIntensity(auto&& EyePoint, auto&& RayDirection, auto&& DistanceField, auto Hardness) {
-		auto OccludedIntensity = 1.;
-		for (auto TraveledDistance = 1e-3; auto _ : Range{ MaximumMarchingSteps }) {
-			auto [UnboundingRadius, __] = DistanceField(EyePoint + static_cast<float>(SelfIntersectionDisplacement + TraveledDistance) * RayDirection);
+	auto EstimateOccludedIntensity(auto&& EyePoint, auto&& RayDirection, auto&& DistanceField, auto Hardness, double MarchingDistance = FarthestMarchingDistance) {
+		using PrecisionPolicy = Precision::PolicyOf<decltype(DistanceField)>;
+		auto [OccludedIntensity, UnscaledField] = std::tuple{ 1., DistanceField::WithDistanceEstimates(DistanceField::WithoutLipschitzBounds(DistanceField)) };
+		for (auto TraveledDistance = static_cast<typename PrecisionPolicy::Accumulator>(1e-3); auto _ : Range{ static_cast<int>(MaximumMarchingSteps * ActiveRayQuality.StepLimitScale) }) {
+			auto [UnboundingRadius, __, ___] = UnscaledField(PrecisionPolicy::Advance(EyePoint, SelfIntersectionDisplacement + TraveledDistance, RayDirection));
 			OccludedIntensity = std::min(OccludedIntensity, std::abs(Hardness * UnboundingRadius / TraveledDistance));
 			TraveledDistance += RelativeStepSizeForOcclusionEstimation * UnboundingRadius;
-			if (UnboundingRadius < IntersectionThreshold)
+			if (UnboundingRadius < ActiveRayQuality.HitThresholdScale * IntersectionThreshold)
 				return 0.;
-			if (TraveledDistance > FarthestMarchingDistance)
+			if (TraveledDistance > MarchingDistance)
 				return OccludedIntensity;
 		}
 		return OccludedIntensity;
 	}
-	auto March(auto&& EyePoint, auto&& RayDirection, auto ReflectionIntensity, auto RefractionIntensity, auto&& DistanceField, auto&& InterruptHandler, auto RecursionDepth)->glm::vec4 {
-		if (auto [TraveledDistance, PointerToObjectRecord] = Intersect(DistanceField, EyePoint, RayDirection); TraveledDistance != NoIntersection) {
-			auto& [DistanceFunction, ObjectMaterial, IlluminationModel] = *PointerToObjectRecord;
-			auto SurfacePosition = EyePoint + static_cast<float>(TraveledDistance) * RayDirection;
-			auto SurfaceNormal = DistanceField::𝛁(DistanceFunction, SurfacePosition);
-			auto EstimateReflectedIntensity = [&] {
+	// The ambient visibility of a surface point from AmbientOcclusionTaps samples of the field along its normal, AmbientOcclusionSpacing
+	// apart. A tap at height h that finds a surface closer than h is occluded by the fraction it falls short by, and every tap weighs
+	// AmbientOcclusionFalloff times as much as the one below it.
+	auto EstimateAmbientOcclusion(auto&& SurfacePosition, auto&& SurfaceNormal, auto&& DistanceField) {
+		using PrecisionPolicy = Precision::PolicyOf<decltype(DistanceField)>;
+		auto UnscaledField = DistanceField::WithDistanceEstimates(DistanceField::WithoutLipschitzBounds(DistanceField));
+		auto [Occlusion, TotalWeight, Weight] = std::tuple{ 0., 0., 1. };
+		for (auto Tap : Range{ 1, AmbientOcclusionTaps + 1 }) {
+			auto Height = AmbientOcclusionSpacing * Tap;
+			auto [UnboundingRadius, _, __] = UnscaledField(PrecisionPolicy::Advance(SurfacePosition, static_cast<typename PrecisionPolicy::Accumulator>(Height), SurfaceNormal));
+			Occlusion += Weight * std::clamp((Height - UnboundingRadius) / Height, 0., 1.);
+			TotalWeight += Weight;
+			Weight *= AmbientOcclusionFalloff;
+		}
+		return TotalWeight > 0 ? 1 - Occlusion / TotalWeight : 1.;
+	}
+	struct ShadowRay {
+		field(Origin, glm::dvec4{});
+		field(Normal, glm::vec4{});
+		field(Direction, glm::vec4{});
+		field(Intensity, glm::vec4{});
+		field(Hardness, 0.);
+		field(DistanceField, static_cast<const void*>(nullptr));
+		field(LightIndex, 0);
+		field(ShadowedByGroups, ~std::uint64_t{ 0 });
+		field(MarchingDistance, 0.);
+		field(Visibility, 1.);
+		field(CachesOcclusion, false);
+		field(Footprint, 0.);
+		field(EstimateOcclusion, static_cast<auto(*)(const ShadowRay&)->double>(nullptr));
+		field(Pixel, 0_z);
+	};
+
+	// While set, illumination models queue each shadow ray here with the intensity it would let through,
+	// and leave marching it to whoever installed the queue.
+	thread_local auto DeferredShadowRays = static_cast<std::vector<ShadowRay>*>(nullptr);
+
+	// Queues x to be marched for MarchingDistance through the casters of its light, capped by the Visibility already known past that.
+	// x keeps the footprint of the surface it leaves, which whoever marches it restores first.
+	auto DeferOcclusionEstimation(ShadowRay x, auto& DistanceField) {
+		using DistanceFieldType = std::decay_t<decltype(DistanceField)>;
+		x.DistanceField = &DistanceField;
+		x.Footprint = DistanceField::Footprint;
+		x.EstimateOcclusion = [](const ShadowRay& x) {
+			auto CasterField = DistanceField::WithShadowCastersOf(*static_cast<const DistanceFieldType*>(x.DistanceField), x.LightIndex, x.ShadowedByGroups);
+			return std::min(x.Visibility, EstimateOccludedIntensity(x.Origin, x.Direction, CasterField, x.Hardness, x.MarchingDistance));
+		};
+		DeferredShadowRays->push_back(x);
+	}
+	auto LocateSurface(auto&& DistanceField, auto& ObjectRecord, auto&& EyePoint, auto TraveledDistance, auto&& RayDirection, double ConeRadius = 0.) {
+		using PrecisionPolicy = Precision::PolicyOf<decltype(DistanceField)>;
+		auto& [DistanceFunction, _, __, ___, ____, _____] = ObjectRecord;
+		DistanceField::Footprint = ActiveRayQuality.FootprintScale * (ConeRadius + PixelConeAngle * TraveledDistance);
+		auto SurfacePosition = PrecisionPolicy::Advance(EyePoint, TraveledDistance, RayDirection);
+		auto SurfaceNormal = DistanceField::𝛁<PrecisionPolicy>(DistanceFunction, SurfacePosition);
+		if (PixelConeAngle > 0)
+			SurfacePosition -= static_cast<typename PrecisionPolicy::Scalar>(DistanceFunction(SurfacePosition)) * typename PrecisionPolicy::Vector{ SurfaceNormal };
+		return std::tuple{ SurfacePosition, SurfaceNormal };
+	}
+	auto EstimateReflectance(auto&& RayDirection, auto&& SurfaceNormal, auto&& ObjectMaterial) {
+		auto cosθi = glm::dot(RayDirection, SurfaceNormal);
+		auto [η1, η2] = [&] {
+			if (cosθi > 0)
+				return std::tuple{ 1., static_cast<double>(ObjectMaterial.ior) };
+			else
+				return std::tuple{ static_cast<double>(ObjectMaterial.ior), 1. };
+		}();
+		if (auto sinθt = η2 / η1 * std::sqrt(std::max(0., 1. - cosθi * cosθi)); sinθt >= 1)
+			return 1.;
+		else {
+			auto cosθt = std::sqrt(std::max(0., 1. - sinθt * sinθt));
+			auto RootOfRs = (η1 * std::abs(cosθi) - η2 * cosθt) / (η1 * std::abs(cosθi) + η2 * cosθt);
+			auto RootOfRp = (η2 * std::abs(cosθi) - η1 * cosθt) / (η2 * std::abs(cosθi) + η1 * cosθt);
+			return (RootOfRs * RootOfRs + RootOfRp * RootOfRp) / 2;
+		}
+	}
+	// The light links of the object being shaded, for illumination models to pick lights and shadow casters by.
+	thread_local auto ShadedObjectLinks = DistanceField::LightLinks{};
+
+	// The ambient occlusion of the next surface to be shaded, when a pass over the G-buffer has already estimated it; the
+	// illumination model that shades that surface takes it from here instead of estimating it again.
+	thread_local auto PendingAmbientOcclusion = std::optional<double>{};
+
+	// The occlusion of each light, sorted by index, at the next surface to be shaded when a pass over the G-buffer has
+	// interpolated it from nearby surfaces; the illumination model that shades that surface takes these instead of
+	// evaluating the shadows of those lights itself. While RecordedShadowOcclusions is set, that model appends the
+	// occlusion of every light it does evaluate to it instead, and leaves the shadow rays it defers to whoever marches them.
+	thread_local auto PendingShadowOcclusions = static_cast<const std::vector<std::tuple<std::size_t, double>>*>(nullptr);
+	thread_local auto RecordedShadowOcclusions = static_cast<std::vector<std::tuple<std::size_t, double>>*>(nullptr);
+
+	// Shades one surface hit, weighted by the throughput of the path that reached it, and hands every reflected
+	// or refracted ray it continues into to Spawn(Origin, Direction, Throughput, ConeRadius, RecursionDepth).
+	// SurfacePosition is kept in the precision of the field, which the illumination model marches shadows from
+	// and the spawned rays start at; the interrupt handler sees it in float.
+	template<SceneFeatures Features = AllFeatures>
+	auto ShadeSurface(auto&& EyePoint, auto&& RayDirection, auto&& SurfacePosition, auto&& SurfaceNormal, auto& ObjectRecord, auto&& SurfacePayload, auto&& Throughput, auto ConeRadius, auto RecursionDepth, auto ReflectionIntensity, auto RefractionIntensity, auto&& InterruptHandler, auto&& Spawn) {
+		using PositionType = std::decay_t<decltype(SurfacePosition)>;
+		auto& [_, ObjectMaterial, IlluminationModel, __, ___, ObjectLinks] = ObjectRecord;
+		auto ShadingPosition = glm::vec4{ SurfacePosition };
+		DistanceField::Footprint = ActiveRayQuality.FootprintScale * ConeRadius;
+		if constexpr (std::invocable<decltype(InterruptHandler)&, decltype(ShadingPosition), decltype(SurfaceNormal), decltype(ObjectRecord), decltype(SurfacePayload)>)
+			InterruptHandler(ShadingPosition, SurfaceNormal, ObjectRecord, SurfacePayload);
+		else
+			InterruptHandler(ShadingPosition, SurfaceNormal, ObjectRecord);
+		auto EnclosingLinks = std::exchange(ShadedObjectLinks, ObjectLinks);
+		if (std::max({ Throughput.x, Throughput.y, Throughput.z }) < ActiveRayQuality.MinimumShadowedThroughput)
+			ShadedObjectLinks.ReceivesShadowsFrom = DistanceField::NoLights;
+		auto SurfaceIntensity = Throughput * IlluminationModel(SurfacePosition, SurfaceNormal, glm::vec4{ EyePoint }, ObjectMaterial);
+		ShadedObjectLinks = EnclosingLinks;
+		if (RecursionDepth >= RecursiveMarchingDepth)
+			return SurfaceIntensity;
+		auto Reflectance = [&] {
+			if constexpr (Features.Reflection && Features.Refraction)
+				return ObjectMaterial.IsReflective && ObjectMaterial.IsTransparent ? static_cast<float>(EstimateReflectance(RayDirection, SurfaceNormal, ObjectMaterial)) : 1.f;
+			else
+				return 1.f;
+		}();
+		if constexpr (Features.Reflection)
+			if (ObjectMaterial.IsReflective) {
 				auto ReflectedRayDirection = Reflect(RayDirection, SurfaceNormal);
-				auto ReflectedLightColor = March(SurfacePosition + SelfIntersectionDisplacement * ReflectedRayDirection, ReflectedRayDirection, ReflectionIntensity, RefractionIntensity, DistanceField, InterruptHandler, RecursionDepth + 1);
-				return glm::vec4{ ReflectedLightColor.x * ObjectMaterial.cReflective.x, ReflectedLightColor.y * ObjectMaterial.cReflective.y, ReflectedLightColor.z * ObjectMaterial.cReflective.z, ReflectedLightColor.w * ObjectMaterial.cReflective.w };
-			};
-			auto EstimateRefractedIntensity = [&] {
+				Spawn(SurfacePosition + static_cast<Precision::ScalarOf<PositionType>>(SelfIntersectionDisplacement) * PositionType{ ReflectedRayDirection }, ReflectedRayDirection, ReflectionIntensity * Reflectance * Throughput * ObjectMaterial.cReflective, ConeRadius, RecursionDepth + 1);
+			}
+		if constexpr (Features.Refraction)
+			if (ObjectMaterial.IsTransparent) {
 				auto [RefractionNormal, η] = [&] {
 					if (glm::dot(RayDirection, SurfaceNormal) > 0)
 						return std::tuple{ -SurfaceNormal, ObjectMaterial.ior };
 					else
 						return std::tuple{ SurfaceNormal, 1 / ObjectMaterial.ior };
 				}();
-				if (auto [TotalInternalReflection, RefractedRayDirection] = Refract(RayDirection, RefractionNormal, η); TotalInternalReflection == false) {
-					auto RefractedLightColor = March(SurfacePosition - SelfIntersectionDisplacement * RefractionNormal, RefractedRayDirection, ReflectionIntensity, RefractionIntensity, DistanceField, InterruptHandler, RecursionDepth + 1);
-					return glm::vec4{ RefractedLightColor.x * ObjectMaterial.cTransparent.x, RefractedLightColor.y * ObjectMaterial.cTransparent.y, RefractedLightColor.z * ObjectMaterial.cTransparent.z, RefractedLightColor.w * ObjectMaterial.cTransparent.w };
-				}
-				else
-					return glm::vec4{ 0, 0, 0, 0 };
-			};
-			auto EstimateReflectance = [&] {
-				auto cosθi = glm::dot(RayDirection, SurfaceNormal);
-				auto [η1, η2] = [&] {
-					if (cosθi > 0)
-						return std::tuple{ 1., static_cast<double>(ObjectMaterial.ior) };
+				auto Transmittance = ObjectMaterial.IsReflective ? 1 - Reflectance : 1.f;
+				if (auto [TotalInternalReflection, RefractedRayDirection] = Refract(RayDirection, RefractionNormal, η); TotalInternalReflection == false)
+					Spawn(SurfacePosition - static_cast<Precision::ScalarOf<PositionType>>(SelfIntersectionDisplacement) * PositionType{ RefractionNormal }, RefractedRayDirection, RefractionIntensity * Transmittance * Throughput * ObjectMaterial.cTransparent, ConeRadius, RecursionDepth + 1);
+			}
+		return SurfaceIntensity;
+	}
+	template<SceneFeatures Features = AllFeatures>
+	auto Shade(auto&& EyePoint, auto&& RayDirection, auto&& SurfacePosition, auto&& SurfaceNormal, auto& ObjectRecord, auto&& SurfacePayload, auto ReflectionIntensity, auto RefractionIntensity, auto&& DistanceField, auto&& InterruptHandler, auto RecursionDepth) {
+		using PositionType = std::decay_t<decltype(SurfacePosition)>;
+		struct PathVertex {
+			field(EyePoint, PositionType{});
+			field(RayDirection, glm::vec4{});
+			field(Throughput, glm::vec4{});
+			field(ConeRadius, 0.);
+			field(RecursionDepth, 0);
+		};
+		auto AccumulatedIntensity = glm::vec4{ 0, 0, 0, 0 };
+		auto PendingRays = std::vector<PathVertex>{};
+		auto Spawn = [&](auto&& Origin, auto&& Direction, auto&& Throughput, auto ConeRadius, auto Depth) {
+			if (std::max({ Throughput.x, Throughput.y, Throughput.z }) >= MinimumPathThroughput)
+				PendingRays.push_back({ .EyePoint = Origin, .RayDirection = Direction, .Throughput = Throughput, .ConeRadius = ConeRadius, .RecursionDepth = static_cast<int>(Depth) });
+		};
+		auto ShadeIntersection = [&](auto&& EyePoint, auto&& RayDirection, auto&& SurfacePosition, auto&& SurfaceNormal, auto& ObjectRecord, auto&& SurfacePayload, auto&& Throughput, auto ConeRadius, auto RecursionDepth) {
+			AccumulatedIntensity += ShadeSurface<Features>(EyePoint, RayDirection, SurfacePosition, SurfaceNormal, ObjectRecord, SurfacePayload, Throughput, ConeRadius, RecursionDepth, ReflectionIntensity, RefractionIntensity, InterruptHandler, Spawn);
+		};
+		PendingRays.reserve(RecursiveMarchingDepth + 1);
+		auto EnclosingQuality = std::exchange(ActiveRayQuality, QualityOfRecursionDepth(RecursionDepth));
+		ShadeIntersection(EyePoint, RayDirection, SurfacePosition, SurfaceNormal, ObjectRecord, SurfacePayload, glm::vec4{ 1, 1, 1, 1 }, PixelConeAngle * glm::length(glm::vec4{ SurfacePosition } - EyePoint), RecursionDepth);
+		while (PendingRays.empty() == false) {
+			auto [Origin, Direction, Throughput, ConeRadius, Depth] = PendingRays.back();
+			PendingRays.pop_back();
+			ActiveRayQuality = QualityOfRecursionDepth(Depth);
+			if (auto [TraveledDistance, PointerToObjectRecord, HitPayload] = Intersect(DistanceField, Origin, Direction, ConeRadius); TraveledDistance != NoIntersection) {
+				auto [HitPosition, HitNormal] = LocateSurface(DistanceField, *PointerToObjectRecord, Origin, TraveledDistance, Direction, ConeRadius);
+				ShadeIntersection(Origin, Direction, HitPosition, HitNormal, *PointerToObjectRecord, HitPayload, Throughput, ConeRadius + PixelConeAngle * TraveledDistance, Depth);
+			}
+			else
+				AccumulatedIntensity += Throughput * ShadeMiss(Origin, Direction);
+		}
+		ActiveRayQuality = EnclosingQuality;
+		return AccumulatedIntensity;
+	}
+	template<SceneFeatures Features = AllFeatures>
+	auto March(auto&& EyePoint, auto&& RayDirection, auto ReflectionIntensity, auto RefractionIntensity, auto&& DistanceField, auto&& InterruptHandler, auto RecursionDepth) {
+		if (auto [TraveledDistance, PointerToObjectRecord, SurfacePayload] = Intersect(DistanceField, EyePoint, RayDirection); TraveledDistance != NoIntersection) {
+			auto [SurfacePosition, SurfaceNormal] = LocateSurface(DistanceField, *PointerToObjectRecord, EyePoint, TraveledDistance, RayDirection);
+			return Shade<Features>(EyePoint, RayDirection, SurfacePosition, SurfaceNormal, *PointerToObjectRecord, SurfacePayload, ReflectionIntensity, RefractionIntensity, DistanceField, InterruptHandler, RecursionDepth);
+		}
+		return ShadeMiss(EyePoint, RayDirection);
+	}
+}
+
+namespace Deferred {
+	auto ShareSupersampledNormals = false;
+	auto LowFrequencyShadingRate = 1;
+	auto ShadowInterpolationTolerance = 0.1;
+
+	// Set by a render to keep the geometry of its primary samples, which guides filters around edges. It is called with the row
+	// and column of every sample, the distance to its hit, the normal there and the index of the object hit among those of the
+	// field; or with NoIntersection, the reversed ray direction and -1 where the ray escaped.
+	auto ExportGeometry = std::function<auto(std::ptrdiff_t, std::ptrdiff_t, double, const glm::vec4&, std::ptrdiff_t)->void>{};
+
+	template<typename ObjectRecordPointerType, typename PositionType = glm::vec4>
+	struct GeometryBuffer {
+		field(Height, 0_z);
+		field(Width, 0_z);
+		field(SurfacePositions, std::vector<PositionType>{});
+		field(SurfaceNormals, std::vector<glm::vec4>{});
+		field(RayDirections, std::vector<glm::vec4>{});
+		field(TraveledDistances, std::vector<double>{});
+		field(ObjectRecords, std::vector<ObjectRecordPointerType>{});
+		field(SurfacePayloads, std::vector<DistanceField::Payload>{});
+
+	public:
+		GeometryBuffer() = default;
+		GeometryBuffer(std::integral auto Height, std::integral auto Width) {
+			this->Height = Height;
+			this->Width = Width;
+			this->SurfacePositions.resize(Height * Width);
+			this->SurfaceNormals.resize(Height * Width);
+			this->RayDirections.resize(Height * Width);
+			this->TraveledDistances.resize(Height * Width, Ray::NoIntersection);
+			this->ObjectRecords.resize(Height * Width, nullptr);
+			this->SurfacePayloads.resize(Height * Width);
+		}
+	};
+
+	auto Rasterize(auto& GBuffer, auto&& EyePoint, auto&& RayCaster, auto&& DistanceField, auto ColumnOffset, auto GroupSize) {
+		using PrecisionPolicy = Precision::PolicyOf<decltype(DistanceField)>;
+		using PositionType = typename std::decay_t<decltype(GBuffer.SurfacePositions)>::value_type;
+		for (auto y : Range{ GBuffer.Height })
+			for (auto x : Range{ GBuffer.Width }) {
+				auto Index = y * GBuffer.Width + x;
+				auto RayDirection = RayCaster(y, x + ColumnOffset);
+				auto [TraveledDistance, PointerToObjectRecord, SurfacePayload] = Ray::Intersect(DistanceField, EyePoint, RayDirection);
+				GBuffer.RayDirections[Index] = RayDirection;
+				GBuffer.TraveledDistances[Index] = TraveledDistance;
+				GBuffer.ObjectRecords[Index] = PointerToObjectRecord;
+				GBuffer.SurfacePayloads[Index] = SurfacePayload;
+				if (TraveledDistance != Ray::NoIntersection)
+					GBuffer.SurfacePositions[Index] = PositionType{ PrecisionPolicy::Advance(EyePoint, TraveledDistance, RayDirection) };
+			}
+		auto EstimateNormal = [&](auto& ObjectRecord, auto&& SurfacePosition) {
+			auto& [DistanceFunction, _, __, ___, ____, _____] = ObjectRecord;
+			return DistanceField::𝛁<PrecisionPolicy>(DistanceFunction, SurfacePosition);
+		};
+		auto EstimateNormalForEachSample = [&](auto yStart, auto yEnd, auto xStart, auto xEnd) {
+			for (auto y : Range{ yStart, yEnd })
+				for (auto x : Range{ xStart, xEnd })
+					if (auto Index = y * GBuffer.Width + x; GBuffer.ObjectRecords[Index] != nullptr)
+						std::tie(GBuffer.SurfacePositions[Index], GBuffer.SurfaceNormals[Index]) = Ray::LocateSurface(DistanceField, *GBuffer.ObjectRecords[Index], EyePoint, GBuffer.TraveledDistances[Index], GBuffer.RayDirections[Index]);
+		};
+		auto EstimateSharedNormal = [&](auto yStart, auto yEnd, auto xStart, auto xEnd) {
+			auto [SharedObjectRecord, Centroid] = std::tuple{ GBuffer.ObjectRecords[yStart * GBuffer.Width + xStart], PositionType{ 0, 0, 0, 0 } };
+			for (auto y : Range{ yStart, yEnd })
+				for (auto x : Range{ xStart, xEnd })
+					if (auto Index = y * GBuffer.Width + x; GBuffer.ObjectRecords[Index] != SharedObjectRecord)
+						return false;
 					else
-						return std::tuple{ static_cast<double>(ObjectMaterial.ior), 1. };
-				}();
-				if (auto sinθt = η2 / η1 * std::sqrt(std::max(0., 1. - cosθi * cosθi)); sinθt >= 1)
-					return 1.;
-				else {
-					auto cosθt = std::sqrt(std::max(0., 1. - sinθt * sinθt));
-					auto RootOfRs = (η1 * std::abs(cosθi) - η2 * cosθt) / (η1 * std::abs(cosθi) + η2 * cosθt);
-					auto RootOfRp = (η2 * std::abs(cosθi) - η1 * cosθt) / (η2 * std::abs(cosθi) + η1 * cosθt);
-					return (RootOfRs * RootOfRs + RootOfRp * RootOfRp) / 2;
-				}
-			};
-			InterruptHandler(SurfacePosition, SurfaceNormal, *PointerToObjectRecord);
-			auto AccumulatedIntensity = IlluminationModel(SurfacePosition, SurfaceNormal, EyePoint, ObjectMaterial);
-			if (RecursionDepth < RecursiveMarchingDepth)
-				if (ObjectMaterial.IsReflective && ObjectMaterial.IsTransparent) {
-					auto Reflectance = static_cast<float>(EstimateReflectance());
-					AccumulatedIntensity += ReflectionIntensity * Reflectance * EstimateReflectedIntensity();
-					AccumulatedIntensity += RefractionIntensity * (1 - Reflectance) * EstimateRefractedIntensity();
+						Centroid += GBuffer.SurfacePositions[Index];
+			if (SharedObjectRecord == nullptr)
+				return true;
+			auto SharedNormal = EstimateNormal(*SharedObjectRecord, Centroid / static_cast<Precision::ScalarOf<PositionType>>((yEnd - yStart) * (xEnd - xStart)));
+			for (auto y : Range{ yStart, yEnd })
+				for (auto x : Range{ xStart, xEnd })
+					GBuffer.SurfaceNormals[y * GBuffer.Width + x] = SharedNormal;
+			return true;
+		};
+		for (auto yStart : Range{ 0_z, GBuffer.Height, static_cast<std::ptrdiff_t>(GroupSize) })
+			for (auto xStart = -(ColumnOffset % GroupSize); xStart < GBuffer.Width; xStart += GroupSize) {
+				auto [yEnd, xEnd] = std::tuple{ std::min(yStart + GroupSize, GBuffer.Height), std::min(xStart + GroupSize, GBuffer.Width) };
+				auto GroupIsComplete = xStart >= 0 && yEnd - yStart == GroupSize && xEnd - xStart == GroupSize;
+				if (GroupSize == 1 || ShareSupersampledNormals == false || GroupIsComplete == false || EstimateSharedNormal(yStart, yEnd, xStart, xEnd) == false)
+					EstimateNormalForEachSample(yStart, yEnd, std::max(xStart, 0_z), xEnd);
+			}
+	}
+	auto ExportGuides(auto& GBuffer, auto&& DistanceField, auto ColumnOffset) {
+		if (!ExportGeometry)
+			return;
+		auto IndexOf = [&](auto PointerToObjectRecord) -> std::ptrdiff_t {
+			if constexpr (requires { std::data(*DistanceField.ObjectRecords); })
+				return PointerToObjectRecord - std::data(*DistanceField.ObjectRecords);
+			else
+				return 0;
+		};
+		for (auto y : Range{ GBuffer.Height })
+			for (auto x : Range{ GBuffer.Width })
+				if (auto Index = y * GBuffer.Width + x; GBuffer.ObjectRecords[Index] != nullptr)
+					ExportGeometry(y, x + ColumnOffset, GBuffer.TraveledDistances[Index], GBuffer.SurfaceNormals[Index], IndexOf(GBuffer.ObjectRecords[Index]));
+				else
+					ExportGeometry(y, x + ColumnOffset, Ray::NoIntersection, -GBuffer.RayDirections[Index], -1);
+	}
+	// Soft shadows and ambient occlusion vary slowly across most surfaces, so with a LowFrequencyShadingRate of n they are only
+	// evaluated at every n-th hit along both axes, and the hits in between interpolate the four nearest of those. Interpolation
+	// weights are bilinear, and weighted down where normals or distances from the eye differ, so that neither bleeds across
+	// silhouettes and creases. Visit(SampleIndex, Weight) is called for each of the four with a positive weight.
+	auto ForEachCoarseNeighbor(auto& GBuffer, std::integral auto Stride, std::integral auto y, std::integral auto x, auto&& Visit) {
+		constexpr auto NormalSharpness = 16.;
+		constexpr auto RelativeDepthTolerance = 0.05;
+		auto Index = y * GBuffer.Width + x;
+		for (auto Corner : Range{ 4 }) {
+			auto [ySample, xSample] = std::tuple{ y / Stride * Stride + (Corner >> 1) * Stride, x / Stride * Stride + (Corner & 1) * Stride };
+			if (ySample >= GBuffer.Height || xSample >= GBuffer.Width || GBuffer.ObjectRecords[ySample * GBuffer.Width + xSample] == nullptr)
+				continue;
+			auto SampleIndex = ySample * GBuffer.Width + xSample;
+			auto SpatialWeight = (1 - std::abs(ySample - y) / static_cast<double>(Stride)) * (1 - std::abs(xSample - x) / static_cast<double>(Stride));
+			auto NormalWeight = std::pow(std::max(0., static_cast<double>(glm::dot(GBuffer.SurfaceNormals[Index], GBuffer.SurfaceNormals[SampleIndex]))), NormalSharpness);
+			auto DepthWeight = std::max(0., 1 - std::abs(GBuffer.TraveledDistances[Index] - GBuffer.TraveledDistances[SampleIndex]) / (RelativeDepthTolerance * GBuffer.TraveledDistances[Index]));
+			if (auto Weight = SpatialWeight * NormalWeight * DepthWeight; Weight > 0)
+				Visit(SampleIndex, Weight);
+		}
+	}
+	// The ambient occlusion of every hit in GBuffer when it is shaded at a reduced LowFrequencyShadingRate, and nothing otherwise,
+	// which leaves it to the illumination models. Hits without any similar neighbor are estimated on their own.
+	auto ResolveAmbientOcclusion(auto& GBuffer, auto&& DistanceField) {
+		auto AmbientOcclusion = std::vector<double>{};
+		if (Ray::AmbientOcclusionTaps <= 0 || LowFrequencyShadingRate <= 1)
+			return AmbientOcclusion;
+		auto Stride = static_cast<std::ptrdiff_t>(LowFrequencyShadingRate);
+		AmbientOcclusion.resize(GBuffer.Height * GBuffer.Width, 1.);
+		auto Estimate = [&](auto Index) {
+			return Ray::EstimateAmbientOcclusion(GBuffer.SurfacePositions[Index], GBuffer.SurfaceNormals[Index], DistanceField);
+		};
+		for (auto y : Range{ 0_z, GBuffer.Height, Stride })
+			for (auto x : Range{ 0_z, GBuffer.Width, Stride })
+				if (auto Index = y * GBuffer.Width + x; GBuffer.ObjectRecords[Index] != nullptr)
+					AmbientOcclusion[Index] = Estimate(Index);
+		for (auto y : Range{ GBuffer.Height })
+			for (auto x : Range{ GBuffer.Width }) {
+				auto Index = y * GBuffer.Width + x;
+				if (GBuffer.ObjectRecords[Index] == nullptr || (y % Stride == 0 && x % Stride == 0))
+					continue;
+				auto [Interpolation, TotalWeight] = std::tuple{ 0., 0. };
+				ForEachCoarseNeighbor(GBuffer, Stride, y, x, [&](auto SampleIndex, auto Weight) {
+					Interpolation += Weight * AmbientOcclusion[SampleIndex];
+					TotalWeight += Weight;
+				});
+				AmbientOcclusion[Index] = TotalWeight > 1e-3 ? Interpolation / TotalWeight : Estimate(Index);
+			}
+		return AmbientOcclusion;
+	}
+	// The occlusion of each light that the coarse neighbors of the hit at (y, x) have recorded in ShadowOcclusions, sorted by
+	// light index. A light is left out, and its shadow evaluated exactly, where no similar neighbor has recorded it or where
+	// the neighbors disagree by more than ShadowInterpolationTolerance, which keeps shadow edges at full resolution.
+	auto InterpolateShadowOcclusions(auto& GBuffer, auto& ShadowOcclusions, std::integral auto Stride, std::integral auto y, std::integral auto x, auto& InterpolatedOcclusions) {
+		thread_local auto Candidates = std::vector<std::tuple<std::size_t, double, double>>{};
+		Candidates.clear();
+		InterpolatedOcclusions.clear();
+		ForEachCoarseNeighbor(GBuffer, Stride, y, x, [&](auto SampleIndex, auto Weight) {
+			for (auto [LightIndex, Occlusion] : ShadowOcclusions[SampleIndex])
+				Candidates.push_back({ LightIndex, Occlusion, Weight });
+		});
+		std::sort(Candidates.begin(), Candidates.end());
+		for (auto Start = Candidates.begin(); Start != Candidates.end();) {
+			auto [Interpolation, TotalWeight, Lowest, Highest] = std::tuple{ 0., 0., 1., 0. };
+			auto End = Start;
+			for (; End != Candidates.end() && std::get<0>(*End) == std::get<0>(*Start); ++End) {
+				auto [_, Occlusion, Weight] = *End;
+				std::tie(Lowest, Highest) = std::tuple{ std::min(Lowest, Occlusion), std::max(Highest, Occlusion) };
+				std::tie(Interpolation, TotalWeight) = std::tuple{ Interpolation + Weight * Occlusion, TotalWeight + Weight };
+			}
+			if (TotalWeight > 1e-3 && Highest - Lowest <= ShadowInterpolationTolerance)
+				InterpolatedOcclusions.push_back({ std::get<0>(*Start), Interpolation / TotalWeight });
+			Start = End;
+		}
+	}
+	template<Ray::SceneFeatures Features = Ray::AllFeatures>
+	auto Resolve(auto&& Canvas, auto& GBuffer, auto&& EyePoint, auto ReflectionIntensity, auto RefractionIntensity, auto&& DistanceField, auto&& InterruptHandler, auto ColumnOffset) {
+		auto AmbientOcclusion = ResolveAmbientOcclusion(GBuffer, DistanceField);
+		auto ResolvePixel = [&](auto Index) {
+			auto AccumulatedIntensity = [&] {
+				if (GBuffer.ObjectRecords[Index] != nullptr) {
+					if (AmbientOcclusion.empty() == false)
+						Ray::PendingAmbientOcclusion = AmbientOcclusion[Index];
+					auto SurfaceIntensity = Ray::Shade<Features>(EyePoint, GBuffer.RayDirections[Index], GBuffer.SurfacePositions[Index], GBuffer.SurfaceNormals[Index], *GBuffer.ObjectRecords[Index], GBuffer.SurfacePayloads[Index], ReflectionIntensity, RefractionIntensity, DistanceField, InterruptHandler, 1);
+					Ray::PendingAmbientOcclusion.reset();
+					return SurfaceIntensity;
 				}
-				else if (ObjectMaterial.IsReflective)
-					AccumulatedIntensity += ReflectionIntensity * EstimateReflectedIntensity();
-				else if (ObjectMaterial.IsTransparent)
-					AccumulatedIntensity += RefractionIntensity * EstimateRefractedIntensity();
-			return AccumulatedIntensity;
+				else
+					return Ray::ShadeMiss(EyePoint, GBuffer.RayDirections[Index]);
+			}();
+			auto [y, x] = std::tuple{ Index / GBuffer.Width, Index % GBuffer.Width + ColumnOffset };
+			Canvas[0][y][x] = AccumulatedIntensity.x;
+			Canvas[1][y][x] = AccumulatedIntensity.y;
+			Canvas[2][y][x] = AccumulatedIntensity.z;
+		};
+		if (LowFrequencyShadingRate <= 1) {
+			for (auto Index : Range{ GBuffer.Height * GBuffer.Width })
+				ResolvePixel(Index);
+			return;
 		}
-		return glm::vec4{ 0, 0, 0, 0 };
+
+		// The hits of the coarse grid are shaded first and record the shadows they evaluate, which the hits in between then interpolate.
+		auto Stride = static_cast<std::ptrdiff_t>(LowFrequencyShadingRate);
+		auto ShadowOcclusions = std::vector<std::vector<std::tuple<std::size_t, double>>>(GBuffer.Height * GBuffer.Width);
+		auto InterpolatedOcclusions = std::vector<std::tuple<std::size_t, double>>{};
+		for (auto y : Range{ 0_z, GBuffer.Height, Stride })
+			for (auto x : Range{ 0_z, GBuffer.Width, Stride }) {
+				auto Index = y * GBuffer.Width + x;
+				Ray::RecordedShadowOcclusions = &ShadowOcclusions[Index];
+				ResolvePixel(Index);
+				Ray::RecordedShadowOcclusions = nullptr;
+				std::sort(ShadowOcclusions[Index].begin(), ShadowOcclusions[Index].end());
+			}
+		for (auto y : Range{ GBuffer.Height })
+			for (auto x : Range{ GBuffer.Width }) {
+				if (y % Stride == 0 && x % Stride == 0)
+					continue;
+				auto Index = y * GBuffer.Width + x;
+				if (GBuffer.ObjectRecords[Index] != nullptr) {
+					InterpolateShadowOcclusions(GBuffer, ShadowOcclusions, Stride, y, x, InterpolatedOcclusions);
+					Ray::PendingShadowOcclusions = &InterpolatedOcclusions;
+				}
+				ResolvePixel(Index);
+				Ray::PendingShadowOcclusions = nullptr;
+			}
+	}
+	template<Ray::SceneFeatures Features = Ray::AllFeatures>
+	auto Render(auto&& Canvas, auto&& EyePoint, auto&& RayCaster, auto ReflectionIntensity, auto RefractionIntensity, auto&& DistanceField, auto&& InterruptHandler, std::integral auto Height, std::integral auto ColumnStart, std::integral auto ColumnEnd, std::integral auto GroupSize) {
+		using ObjectRecordPointerType = decltype([&] {
+			auto [_, PointerToObjectRecord, __] = DistanceField(EyePoint);
+			return PointerToObjectRecord;
+			}());
+		auto GBuffer = GeometryBuffer<ObjectRecordPointerType, typename Precision::PolicyOf<decltype(DistanceField)>::Vector>{ Height, ColumnEnd - ColumnStart };
+		Rasterize(GBuffer, EyePoint, RayCaster, DistanceField, static_cast<std::ptrdiff_t>(ColumnStart), static_cast<std::ptrdiff_t>(GroupSize));
+		ExportGuides(GBuffer, DistanceField, static_cast<std::ptrdiff_t>(ColumnStart));
+		Resolve<Features>(Canvas, GBuffer, EyePoint, ReflectionIntensity, RefractionIntensity, DistanceField, InterruptHandler, static_cast<std::ptrdiff_t>(ColumnStart));
 	}
 }
 
 namespace Illuminations {
+	// Set by a render to answer shadow queries from precomputed maps. For the light with the given index and a surface
+	// point, it gives the visibility due to everything farther than some distance along the shadow ray, and that
+	// distance, which is all the shadow ray still has to be marched for; or nothing where the maps do not cover the point.
+	auto ShadowLookup = std::function<auto(std::size_t, const glm::vec4&, const glm::vec4&, double)->std::optional<std::tuple<double, double>>>{};
+
+	// Set by a render to share the occlusion of a light between nearby points of surfaces that cache its shadows.
+	// LookUpOcclusion gives the occlusion interpolated around a surface point, or nothing where too little is known
+	// there, and RecordOcclusion hands it every occlusion evaluated exactly instead.
+	auto LookUpOcclusion = std::function<auto(std::size_t, const glm::vec4&, const glm::vec4&)->std::optional<double>>{};
+	auto RecordOcclusion = std::function<auto(std::size_t, const glm::vec4&, const glm::vec4&, double)->void>{};
+
+	// Lights are sorted into a LightHierarchy here, so Lights must not change while the model is in use.
+	template<Ray::SceneFeatures Features = Ray::AllFeatures>
 	auto ConfigureIlluminationModel(auto& Lights, auto Ka, auto Kd, auto Ks, auto& DistanceField, auto Hardness) {
+		auto Hierarchy = std::make_shared<const LightHierarchy>(LightHierarchy::Build(Lights));
 		return [=, &Lights, &DistanceField](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& EyePoint, auto&& ObjectMaterial) {
-			auto AccumulatedIntensity = Ka * ObjectMaterial.cAmbient;
-			for (auto&& Light : Lights) {
+			thread_local auto ReachingLights = std::vector<std::size_t>{};
+			thread_local auto SampledLights = std::vector<std::tuple<std::size_t, float>>{};
+			auto PendingShadows = std::exchange(Ray::PendingShadowOcclusions, nullptr);
+			auto RecordedShadows = std::exchange(Ray::RecordedShadowOcclusions, nullptr);
+			// Lights are evaluated in float, while shadows and ambient occlusion are marched from the position in full.
+			auto ShadingPosition = glm::vec4{ SurfacePosition };
+			auto AmbientVisibility = [&] {
+				if (auto ResolvedAmbientOcclusion = std::exchange(Ray::PendingAmbientOcclusion, std::nullopt))
+					return *ResolvedAmbientOcclusion;
+				if (Ray::AmbientOcclusionTaps > 0 && Ka != 0 && glm::vec3{ ObjectMaterial.cAmbient } != glm::vec3{ 0, 0, 0 })
+					return Ray::EstimateAmbientOcclusion(SurfacePosition, SurfaceNormal, DistanceField);
+				return 1.;
+			}();
+			auto AccumulatedIntensity = static_cast<float>(AmbientVisibility) * (Ka * ObjectMaterial.cAmbient);
+			auto& Receiver = Ray::ShadedObjectLinks;
+			ReachingLights.clear();
+			Hierarchy->Gather(ShadingPosition, ReachingLights);
+			std::erase_if(ReachingLights, [&](auto LightIndex) { return !DistanceField::Links(Receiver.LitBy, LightIndex); });
+			std::sort(ReachingLights.begin(), ReachingLights.end());
+			SampleLights(Lights, ShadingPosition, ReachingLights, SampledLights);
+			for (auto [LightIndex, LightWeight] : SampledLights) {
+				auto& Light = Lights[LightIndex];
 				auto LightDirection = [&] {
-					if (Light.type == LightType::LIGHT_POINT)
-						return glm::normalize(SurfacePosition - Light.pos);
+					if constexpr (Features.OnlyDirectionalLights)
+						return glm::normalize(Light.dir);
+					else if (Light.type == LightType::LIGHT_POINT)
+						return glm::normalize(ShadingPosition - Light.pos);
 					else if (Light.type == LightType::LIGHT_DIRECTIONAL)
 						return glm::normalize(Light.dir);
+					else if (Light.type == LightType::LIGHT_SPOT || Light.type == LightType::LIGHT_AREA)
+						return glm::normalize(ShadingPosition - NearestEmitterPoint(Light, ShadingPosition));
 					else
 						throw std::runtime_error{ "Unrecognized light type detected!" };
 				}();
-				auto LightColor = [&] {
-                                        if (Light.type == LightType::LIGHT_POINT) {
-                                                auto LightDisplacement = SurfacePosition - Light.pos;
+				auto LightColor = LightWeight * [&] {
+					if constexpr (Features.OnlyDirectionalLights)
+						return Light.color;
+                                        else if (Light.type == LightType::LIGHT_POINT) {
+                                                auto LightDisplacement = ShadingPosition - Light.pos;
                                                 auto SquaredLightDistance = glm::dot(LightDisplacement, LightDisplacement);
                                                 auto LightDistance = std::sqrt(SquaredLightDistance);
                                                 return std::min(1 / (Light.function.x + Light.function.y * LightDistance + Light.function.z * SquaredLightDistance), 1.f) * Light.color;
                                         }
+					else if (Light.type == LightType::LIGHT_SPOT || Light.type == LightType::LIGHT_AREA) {
+						auto LightDistance = glm::length(ShadingPosition - NearestEmitterPoint(Light, ShadingPosition));
+						return std::min(1 / (Light.function.x + Light.function.y * LightDistance + Light.function.z * LightDistance * LightDistance), 1.f) * EstimateEmission(Light, LightDirection) * Light.color;
+					}
                                         else
 						return Light.color;
 				}();
-                                auto OccludedIntensity = static_cast<float>(Ray::EstimateOccludedIntensity(SurfacePosition, -LightDirection, DistanceField, Hardness));
-                                AccumulatedIntensity += OccludedIntensity * Diffuse(LightDirection, SurfaceNormal, LightColor, Kd * ObjectMaterial.cDiffuse);
-				AccumulatedIntensity += OccludedIntensity * Specular(LightDirection, SurfaceNormal, glm::normalize(EyePoint - SurfacePosition), LightColor, Ks * ObjectMaterial.cSpecular, ObjectMaterial.shininess);
+				auto [ShadowHardness, ShadowDistance] = [&] {
+					if constexpr (Features.OnlyDirectionalLights)
+						return std::tuple{ static_cast<double>(Hardness), Ray::FarthestMarchingDistance };
+					else if (Light.type == LightType::LIGHT_SPOT || Light.type == LightType::LIGHT_AREA) {
+						auto [EmitterRadius, EmitterDistance] = MeasureEmitter(Light, ShadingPosition);
+						return std::tuple{ EmitterRadius > 0 ? EmitterDistance / EmitterRadius : static_cast<double>(Hardness), EmitterDistance };
+					}
+					return std::tuple{ static_cast<double>(Hardness), Ray::FarthestMarchingDistance };
+				}();
+				auto DiffuseIntensity = Diffuse(LightDirection, SurfaceNormal, LightColor, Kd * ObjectMaterial.cDiffuse);
+				auto SpecularIntensity = Specular(LightDirection, SurfaceNormal, glm::normalize(EyePoint - ShadingPosition), LightColor, Ks * ObjectMaterial.cSpecular, ObjectMaterial.shininess);
+				if (Features.Shadows == false || !DistanceField::Links(Receiver.ReceivesShadowsFrom, LightIndex)) {
+					AccumulatedIntensity += DiffuseIntensity;
+					AccumulatedIntensity += SpecularIntensity;
+					continue;
+				}
+				if (PendingShadows != nullptr)
+					if (auto x = std::lower_bound(PendingShadows->begin(), PendingShadows->end(), std::tuple{ LightIndex, -1. }); x != PendingShadows->end() && std::get<0>(*x) == LightIndex) {
+						AccumulatedIntensity += static_cast<float>(std::get<1>(*x)) * DiffuseIntensity;
+						AccumulatedIntensity += static_cast<float>(std::get<1>(*x)) * SpecularIntensity;
+						continue;
+					}
+				auto CachesOcclusion = LookUpOcclusion && DistanceField::Links(Receiver.CachesShadowsFrom, LightIndex);
+				if (CachesOcclusion)
+					if (auto CachedOcclusion = LookUpOcclusion(LightIndex, ShadingPosition, SurfaceNormal)) {
+						if (RecordedShadows != nullptr)
+							RecordedShadows->push_back({ LightIndex, *CachedOcclusion });
+						AccumulatedIntensity += static_cast<float>(*CachedOcclusion) * DiffuseIntensity;
+						AccumulatedIntensity += static_cast<float>(*CachedOcclusion) * SpecularIntensity;
+						continue;
+					}
+				auto [Visibility, MarchingDistance] = std::tuple{ 1., ShadowDistance };
+				if (ShadowLookup && Receiver.ShadowedByGroups == ~std::uint64_t{ 0 })
+					if (auto MappedVisibility = ShadowLookup(LightIndex, ShadingPosition, SurfaceNormal, ShadowHardness))
+						std::tie(Visibility, MarchingDistance) = *MappedVisibility;
+				if (Ray::DeferredShadowRays) {
+					Ray::DeferOcclusionEstimation({
+						.Origin = glm::dvec4{ SurfacePosition },
+						.Normal = SurfaceNormal,
+						.Direction = -LightDirection,
+						.Intensity = DiffuseIntensity + SpecularIntensity,
+						.Hardness = ShadowHardness,
+						.LightIndex = static_cast<int>(LightIndex),
+						.ShadowedByGroups = Receiver.ShadowedByGroups,
+						.MarchingDistance = MarchingDistance,
+						.Visibility = Visibility,
+						.CachesOcclusion = CachesOcclusion
+					}, DistanceField);
+					continue;
+				}
+				auto CasterField = DistanceField::WithShadowCastersOf(DistanceField, LightIndex, Receiver.ShadowedByGroups);
+				auto OccludedIntensity = static_cast<float>(std::min(Visibility, Ray::EstimateOccludedIntensity(SurfacePosition, -LightDirection, CasterField, ShadowHardness, MarchingDistance)));
+				if (CachesOcclusion)
+					RecordOcclusion(LightIndex, ShadingPosition, SurfaceNormal, OccludedIntensity);
+				if (RecordedShadows != nullptr)
+					RecordedShadows->push_back({ LightIndex, OccludedIntensity });
+				AccumulatedIntensity += OccludedIntensity * DiffuseIntensity;
+				AccumulatedIntensity += OccludedIntensity * SpecularIntensity;
 			}
 			return AccumulatedIntensity;
 		};
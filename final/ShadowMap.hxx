@@ -0,0 +1,132 @@
+#pragma once
+#include "RayMarching.hxx"
+
+// Shadow maps for directional lights. A pre-pass marches an orthographic grid of rays from the light
+// across a box, exactly as a shadow ray is marched, and every texel keeps the depth of the first surface
+// its ray meets together with its tightest soft-shadow approach before that: the distance to the scene
+// and the depth at the sample where distance / (hit depth - depth) was smallest. A receiver at depth r
+// behind that sample is then lit by Hardness * distance / (r - depth), which is the term a shadow ray
+// from the receiver would have found there. Lookups filter the texels around a receiver (PCF), so the
+// quality of the shadows follows the resolution of the map.
+// Near its receiver, a shadow ray sees surface detail the map cannot hold: the receiver itself is found
+// at the level of detail of the camera ray's footprint, not the map's. So the map only answers for what
+// lies farther than ShadowMapContactDistance texels from the receiver, approaches are only taken from
+// that far before the hit, and the shadow ray is still marched up to there.
+namespace Illuminations {
+	auto ShadowMapFilterRadius = 1;
+	auto ShadowMapContactDistance = 4.f;
+
+	struct ShadowMap {
+		struct Texel {
+			field(Depth, 0.f);
+			field(ApproachDistance, std::numeric_limits<float>::infinity());
+			field(ApproachDepth, 0.f);
+		};
+
+		field(LightDirection, glm::vec3{});
+		field(Right, glm::vec3{});
+		field(Up, glm::vec3{});
+		field(Origin, glm::vec3{});
+		field(Resolution, 0);
+		field(TexelSize, 0.f);
+		field(FarthestDepth, 0.f);
+		field(Texels, std::vector<Texel>{});
+
+	public:
+		// The fraction of the light reaching SurfacePosition past the contact distance, and the contact distance,
+		// or nothing if the map does not cover SurfacePosition.
+		auto Visibility(auto&& SurfacePosition, double Hardness) const -> std::optional<std::tuple<double, double>> {
+			auto Position = glm::vec3{ SurfacePosition };
+			auto [u, v, Depth] = std::tuple{ glm::dot(Position - Origin, Right) / TexelSize - 0.5f, glm::dot(Position - Origin, Up) / TexelSize - 0.5f, glm::dot(Position - Origin, LightDirection) };
+			auto [Margin, ContactDistance] = std::tuple{ static_cast<float>(ShadowMapFilterRadius), ShadowMapContactDistance * TexelSize };
+			if (!(u >= Margin && v >= Margin && u < Resolution - 1 - Margin && v < Resolution - 1 - Margin && Depth >= 0 && Depth <= FarthestDepth))
+				return std::nullopt;
+			auto TexelVisibility = [&](auto x, auto y) {
+				auto& [TexelDepth, ApproachDistance, ApproachDepth] = Texels[y * Resolution + x];
+				if (TexelDepth < Depth - ContactDistance)
+					return 0.;
+				if (ApproachDepth < Depth - ContactDistance)
+					return std::min(1., Hardness * ApproachDistance / (Depth - ApproachDepth));
+				return 1.;
+			};
+			auto [x, y] = std::tuple{ static_cast<int>(u), static_cast<int>(v) };
+			auto [fx, fy] = std::tuple{ static_cast<double>(u - x), static_cast<double>(v - y) };
+			auto AccumulatedVisibility = 0.;
+			for (auto dy = -ShadowMapFilterRadius; dy <= ShadowMapFilterRadius; dy++)
+				for (auto dx = -ShadowMapFilterRadius; dx <= ShadowMapFilterRadius; dx++)
+					AccumulatedVisibility += (1 - fy) * ((1 - fx) * TexelVisibility(x + dx, y + dy) + fx * TexelVisibility(x + dx + 1, y + dy)) + fy * ((1 - fx) * TexelVisibility(x + dx, y + dy + 1) + fx * TexelVisibility(x + dx + 1, y + dy + 1));
+			return std::tuple{ AccumulatedVisibility / ((2 * ShadowMapFilterRadius + 1) * (2 * ShadowMapFilterRadius + 1)), static_cast<double>(ContactDistance) };
+		}
+	};
+
+	// Bakes a Resolution x Resolution map of the shadows cast by DistanceField under light travelling along
+	// LightDirection, covering BoundingBox. Positions are given the w of the lower corner of the box.
+	auto BuildShadowMap(auto&& DistanceField, auto&& LightDirection, auto&& BoundingBox, std::integral auto Resolution) {
+		using PrecisionPolicy = Precision::PolicyOf<decltype(DistanceField)>;
+		auto& [LowerCorner, UpperCorner] = BoundingBox;
+		auto Direction = glm::normalize(glm::vec3{ LightDirection });
+		auto Right = glm::normalize(glm::cross(std::abs(Direction.y) < 0.99f ? glm::vec3{ 0, 1, 0 } : glm::vec3{ 1, 0, 0 }, Direction));
+		auto Up = glm::cross(Direction, Right);
+		auto [Lower, Upper] = std::tuple{ glm::vec3{ Ray::Unbounded }, glm::vec3{ -Ray::Unbounded } };
+		for (auto Corner : Range{ 8 }) {
+			auto Point = glm::vec3{ Corner & 1 ? UpperCorner.x : LowerCorner.x, Corner & 2 ? UpperCorner.y : LowerCorner.y, Corner & 4 ? UpperCorner.z : LowerCorner.z };
+			auto Projection = glm::vec3{ glm::dot(Point, Right), glm::dot(Point, Up), glm::dot(Point, Direction) };
+			std::tie(Lower, Upper) = std::tuple{ glm::min(Lower, Projection), glm::max(Upper, Projection) };
+		}
+		auto Map = ShadowMap{
+			.LightDirection = Direction,
+			.Right = Right,
+			.Up = Up,
+			.Origin = Lower.x * Right + Lower.y * Up + Lower.z * Direction,
+			.Resolution = static_cast<int>(Resolution),
+			.TexelSize = std::max(Upper.x - Lower.x, Upper.y - Lower.y) / Resolution,
+			.FarthestDepth = Upper.z - Lower.z,
+			.Texels = std::vector<ShadowMap::Texel>(static_cast<std::size_t>(Resolution) * Resolution)
+		};
+		auto [UnscaledField, ContactDistance] = std::tuple{ DistanceField::WithDistanceEstimates(DistanceField::WithoutLipschitzBounds(DistanceField)), ShadowMapContactDistance * Map.TexelSize };
+		Utility::Concurrency::ForEachInParallel(Resolution, [&](auto y) {
+			auto Samples = std::vector<std::tuple<float, float>>{};
+			for (auto x : Range{ Resolution }) {
+				auto EyePoint = glm::vec4{ Map.Origin + (static_cast<float>(x) + 0.5f) * Map.TexelSize * Right + (static_cast<float>(y) + 0.5f) * Map.TexelSize * Up, LowerCorner.w };
+				auto [RayDirection, HitDepth] = std::tuple{ glm::vec4{ Direction, 0 }, Map.FarthestDepth };
+				DistanceField::Footprint = Map.TexelSize / 2;
+				Samples.clear();
+				for (auto TraveledDistance = static_cast<typename PrecisionPolicy::Accumulator>(0); auto _ : Range{ Ray::MaximumMarchingSteps }) {
+					auto [UnboundingRadius, __, ___] = UnscaledField(PrecisionPolicy::Advance(EyePoint, TraveledDistance, RayDirection));
+					if (UnboundingRadius < Ray::IntersectionThreshold) {
+						HitDepth = static_cast<float>(TraveledDistance);
+						break;
+					}
+					Samples.push_back({ static_cast<float>(UnboundingRadius), static_cast<float>(TraveledDistance) });
+					TraveledDistance += Ray::RelativeStepSizeForOcclusionEstimation * UnboundingRadius;
+					if (TraveledDistance > Map.FarthestDepth)
+						break;
+				}
+				auto& Texel = Map.Texels[y * Resolution + x];
+				Texel = { .Depth = HitDepth, .ApproachDepth = HitDepth };
+				for (auto [Distance, Depth] : Samples)
+					if (Depth < HitDepth - ContactDistance && (Texel.ApproachDepth >= HitDepth || Distance * (HitDepth - Texel.ApproachDepth) < Texel.ApproachDistance * (HitDepth - Depth)))
+						std::tie(Texel.ApproachDistance, Texel.ApproachDepth) = std::tuple{ Distance, Depth };
+			}
+		});
+		return Map;
+	}
+
+	// One map per directional light, each baked over the objects that cast shadows from that light; other lights get an empty map.
+	auto BuildShadowMaps(auto&& Lights, auto&& DistanceField, auto&& BoundingBox, std::integral auto Resolution) {
+		auto Maps = std::vector<ShadowMap>(Lights.size());
+		for (auto LightIndex : Range{ Lights.size() })
+			if (Lights[LightIndex].type == LightType::LIGHT_DIRECTIONAL)
+				Maps[LightIndex] = BuildShadowMap(DistanceField::WithShadowCastersOf(DistanceField, static_cast<int>(LightIndex), ~std::uint64_t{ 0 }), Lights[LightIndex].dir, BoundingBox, Resolution);
+		return Maps;
+	}
+
+	// A ShadowLookup that answers from Maps, indexed like the lights they were built for.
+	auto LookUpShadowMaps(std::vector<ShadowMap> Maps) {
+		return [Maps = std::make_shared<const std::vector<ShadowMap>>(std::move(Maps))](std::size_t LightIndex, const glm::vec4& SurfacePosition, const glm::vec4&, double Hardness) -> std::optional<std::tuple<double, double>> {
+			if (LightIndex >= Maps->size() || (*Maps)[LightIndex].Texels.empty())
+				return std::nullopt;
+			return (*Maps)[LightIndex].Visibility(SurfacePosition, Hardness);
+		};
+	}
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include "RayMarching.hxx"
+
+// A breadth-first alternative to Deferred::Render. Rather than following each pixel's reflection and
+// refraction tree depth-first with its shadow rays marched inline, every ray of one generation waits in
+// a queue and each queue is processed as one batch: the hits of a generation are shaded, then all the
+// shadow rays they cast are marched, then the reflected and refracted rays they spawned are marched as
+// the next generation. Shadow and secondary rays are sorted by direction and origin before marching,
+// so consecutive marches walk the same parts of the field.
+namespace Wavefront {
+	template<typename PositionType = glm::vec4>
+	struct PathVertex {
+		field(Pixel, 0_z);
+		field(EyePoint, PositionType{});
+		field(RayDirection, glm::vec4{});
+		field(Throughput, glm::vec4{});
+		field(ConeRadius, 0.);
+		field(RecursionDepth, 0);
+	};
+
+	template<typename ObjectRecordPointerType, typename PositionType = glm::vec4>
+	struct SurfaceHit {
+		field(Vertex, PathVertex<PositionType>{});
+		field(SurfacePosition, PositionType{});
+		field(SurfaceNormal, glm::vec4{});
+		field(ObjectRecord, static_cast<ObjectRecordPointerType>(nullptr));
+		field(SurfacePayload, DistanceField::Payload{});
+	};
+}
+
+namespace Wavefront::ImplementationDetail {
+	auto SpreadBits(std::uint64_t x) {
+		x = (x | x << 16) & 0x030000FF;
+		x = (x | x << 8) & 0x0300F00F;
+		x = (x | x << 4) & 0x030C30C3;
+		return (x | x << 2) & 0x09249249;
+	}
+
+	// Orders rays by the octant of their direction, then along a Morton curve through their origins.
+	auto SortCoherently(auto& Rays, auto&& OriginOf, auto&& DirectionOf) {
+		if (Rays.size() < 2)
+			return;
+		auto [LowerCorner, UpperCorner] = std::tuple{ glm::vec3{ OriginOf(Rays[0]) }, glm::vec3{ OriginOf(Rays[0]) } };
+		for (auto& x : Rays)
+			std::tie(LowerCorner, UpperCorner) = std::tuple{ glm::min(LowerCorner, glm::vec3{ OriginOf(x) }), glm::max(UpperCorner, glm::vec3{ OriginOf(x) }) };
+		auto Scale = 1023.f / glm::max(UpperCorner - LowerCorner, glm::vec3{ std::numeric_limits<float>::min() });
+		auto Keys = std::vector<std::tuple<std::uint64_t, std::size_t>>(Rays.size());
+		for (auto Index : Range{ Rays.size() }) {
+			auto Cell = glm::uvec3{ (glm::vec3{ OriginOf(Rays[Index]) } - LowerCorner) * Scale };
+			auto& Direction = DirectionOf(Rays[Index]);
+			auto Octant = std::uint64_t{ Direction.x < 0 } | std::uint64_t{ Direction.y < 0 } << 1 | std::uint64_t{ Direction.z < 0 } << 2;
+			Keys[Index] = { Octant << 30 | SpreadBits(Cell.z) << 2 | SpreadBits(Cell.y) << 1 | SpreadBits(Cell.x), Index };
+		}
+		std::sort(Keys.begin(), Keys.end());
+		auto SortedRays = std::decay_t<decltype(Rays)>{};
+		SortedRays.reserve(Rays.size());
+		for (auto& [_, Index] : Keys)
+			SortedRays.push_back(std::move(Rays[Index]));
+		Rays = std::move(SortedRays);
+	}
+}
+
+namespace Wavefront {
+	auto SortSecondaryRays = true;
+
+	template<Ray::SceneFeatures Features = Ray::AllFeatures>
+	auto Render(auto&& Canvas, auto&& EyePoint, auto&& RayCaster, auto ReflectionIntensity, auto RefractionIntensity, auto&& DistanceField, auto&& InterruptHandler, std::integral auto Height, std::integral auto ColumnStart, std::integral auto ColumnEnd, std::integral auto GroupSize) {
+		using ObjectRecordPointerType = decltype([&] {
+			auto [_, PointerToObjectRecord, __] = DistanceField(EyePoint);
+			return PointerToObjectRecord;
+			}());
+		using PositionType = typename Precision::PolicyOf<decltype(DistanceField)>::Vector;
+		auto GBuffer = Deferred::GeometryBuffer<ObjectRecordPointerType, PositionType>{ Height, ColumnEnd - ColumnStart };
+		Deferred::Rasterize(GBuffer, EyePoint, RayCaster, DistanceField, static_cast<std::ptrdiff_t>(ColumnStart), static_cast<std::ptrdiff_t>(GroupSize));
+		Deferred::ExportGuides(GBuffer, DistanceField, static_cast<std::ptrdiff_t>(ColumnStart));
+		auto AmbientOcclusion = Deferred::ResolveAmbientOcclusion(GBuffer, DistanceField);
+		auto AccumulatedIntensities = std::vector<glm::vec4>(GBuffer.Height * GBuffer.Width);
+		auto [SurfaceHits, SecondaryRays, ShadowRays] = std::tuple{ std::vector<SurfaceHit<ObjectRecordPointerType, PositionType>>{}, std::vector<PathVertex<PositionType>>{}, std::vector<Ray::ShadowRay>{} };
+		for (auto Index : Range{ GBuffer.Height * GBuffer.Width })
+			if (GBuffer.ObjectRecords[Index] != nullptr) {
+				auto Vertex = PathVertex<PositionType>{ .Pixel = Index, .EyePoint = PositionType{ EyePoint }, .RayDirection = GBuffer.RayDirections[Index], .Throughput = glm::vec4{ 1, 1, 1, 1 }, .ConeRadius = Ray::PixelConeAngle * glm::length(glm::vec4{ GBuffer.SurfacePositions[Index] } - EyePoint), .RecursionDepth = 1 };
+				SurfaceHits.push_back({ Vertex, GBuffer.SurfacePositions[Index], GBuffer.SurfaceNormals[Index], GBuffer.ObjectRecords[Index], GBuffer.SurfacePayloads[Index] });
+			}
+			else
+				AccumulatedIntensities[Index] = Ray::ShadeMiss(EyePoint, GBuffer.RayDirections[Index]);
+		auto ShadeHit = [&](auto& Hit) {
+			auto& [Vertex, SurfacePosition, SurfaceNormal, ObjectRecord, SurfacePayload] = Hit;
+			auto Spawn = [&](auto&& Origin, auto&& Direction, auto&& Throughput, auto ConeRadius, auto Depth) {
+				if (std::max({ Throughput.x, Throughput.y, Throughput.z }) >= Ray::MinimumPathThroughput)
+					SecondaryRays.push_back({ .Pixel = Vertex.Pixel, .EyePoint = Origin, .RayDirection = Direction, .Throughput = Throughput, .ConeRadius = ConeRadius, .RecursionDepth = static_cast<int>(Depth) });
+			};
+			auto FirstShadowRay = ShadowRays.size();
+			if (Vertex.RecursionDepth == 1 && AmbientOcclusion.empty() == false)
+				Ray::PendingAmbientOcclusion = AmbientOcclusion[Vertex.Pixel];
+			Ray::ActiveRayQuality = Ray::QualityOfRecursionDepth(Vertex.RecursionDepth);
+			AccumulatedIntensities[Vertex.Pixel] += Ray::ShadeSurface<Features>(Vertex.EyePoint, Vertex.RayDirection, SurfacePosition, SurfaceNormal, *ObjectRecord, SurfacePayload, Vertex.Throughput, Vertex.ConeRadius, Vertex.RecursionDepth, ReflectionIntensity, RefractionIntensity, InterruptHandler, Spawn);
+			Ray::PendingAmbientOcclusion.reset();
+			for (auto Index : Range{ FirstShadowRay, ShadowRays.size() })
+				ShadowRays[Index].Pixel = Vertex.Pixel, ShadowRays[Index].Intensity *= Vertex.Throughput;
+		};
+		// Resolves every queued shadow ray and calls Record(x, Occlusion) for each. Rays leaving surfaces that cache their
+		// light's occlusion look it up first, since the rays before them in the batch may have recorded it nearby, and
+		// hand it to RecordOcclusion when they have to be marched after all.
+		auto MarchShadowRays = [&](auto&& Record) {
+			if (SortSecondaryRays)
+				ImplementationDetail::SortCoherently(ShadowRays, [](auto& x) -> auto& { return x.Origin; }, [](auto& x) -> auto& { return x.Direction; });
+			for (auto& x : ShadowRays) {
+				DistanceField::Footprint = x.Footprint;
+				auto Occlusion = [&] {
+					auto [LightIndex, ShadingPosition] = std::tuple{ static_cast<std::size_t>(x.LightIndex), glm::vec4{ x.Origin } };
+					if (x.CachesOcclusion)
+						if (auto CachedOcclusion = Illuminations::LookUpOcclusion(LightIndex, ShadingPosition, x.Normal))
+							return static_cast<float>(*CachedOcclusion);
+					auto MarchedOcclusion = static_cast<float>(x.EstimateOcclusion(x));
+					if (x.CachesOcclusion)
+						Illuminations::RecordOcclusion(LightIndex, ShadingPosition, x.Normal, MarchedOcclusion);
+					return MarchedOcclusion;
+				}();
+				Record(x, Occlusion);
+				AccumulatedIntensities[x.Pixel] += Occlusion * x.Intensity;
+			}
+			ShadowRays.clear();
+		};
+		// As in Deferred::Resolve, a LowFrequencyShadingRate above 1 has the primary hits of the coarse grid shaded first and
+		// their shadow rays marched, so the primary hits in between can interpolate the shadows those recorded.
+		auto ShadePrimaryHits = [&] {
+			auto Stride = static_cast<std::ptrdiff_t>(Deferred::LowFrequencyShadingRate);
+			if (Stride <= 1) {
+				for (auto& Hit : SurfaceHits)
+					ShadeHit(Hit);
+				return;
+			}
+			auto ShadowOcclusions = std::vector<std::vector<std::tuple<std::size_t, double>>>(GBuffer.Height * GBuffer.Width);
+			auto InterpolatedOcclusions = std::vector<std::tuple<std::size_t, double>>{};
+			auto FirstInterpolatedHit = std::stable_partition(SurfaceHits.begin(), SurfaceHits.end(), [&](auto& Hit) {
+				return Hit.Vertex.Pixel / GBuffer.Width % Stride == 0 && Hit.Vertex.Pixel % GBuffer.Width % Stride == 0;
+			});
+			for (auto Hit = SurfaceHits.begin(); Hit != FirstInterpolatedHit; ++Hit) {
+				Ray::RecordedShadowOcclusions = &ShadowOcclusions[Hit->Vertex.Pixel];
+				ShadeHit(*Hit);
+				Ray::RecordedShadowOcclusions = nullptr;
+			}
+			MarchShadowRays([&](auto& x, auto Occlusion) { ShadowOcclusions[x.Pixel].push_back({ static_cast<std::size_t>(x.LightIndex), Occlusion }); });
+			for (auto& x : ShadowOcclusions)
+				std::sort(x.begin(), x.end());
+			for (auto Hit = FirstInterpolatedHit; Hit != SurfaceHits.end(); ++Hit) {
+				Deferred::InterpolateShadowOcclusions(GBuffer, ShadowOcclusions, Stride, Hit->Vertex.Pixel / GBuffer.Width, Hit->Vertex.Pixel % GBuffer.Width, InterpolatedOcclusions);
+				Ray::PendingShadowOcclusions = &InterpolatedOcclusions;
+				ShadeHit(*Hit);
+				Ray::PendingShadowOcclusions = nullptr;
+			}
+		};
+		auto EnclosingShadowRays = std::exchange(Ray::DeferredShadowRays, &ShadowRays);
+		for (auto Generation = 0; SurfaceHits.empty() == false; ++Generation) {
+			if (Generation == 0)
+				ShadePrimaryHits();
+			else
+				for (auto& Hit : SurfaceHits)
+					ShadeHit(Hit);
+			Ray::ActiveRayQuality = {};
+			MarchShadowRays([](auto&&...) {});
+			SurfaceHits.clear();
+			if (SortSecondaryRays)
+				ImplementationDetail::SortCoherently(SecondaryRays, [](auto& x) -> auto& { return x.EyePoint; }, [](auto& x) -> auto& { return x.RayDirection; });
+			for (auto& Vertex : SecondaryRays) {
+				Ray::ActiveRayQuality = Ray::QualityOfRecursionDepth(Vertex.RecursionDepth);
+				if (auto [TraveledDistance, PointerToObjectRecord, HitPayload] = Ray::Intersect(DistanceField, Vertex.EyePoint, Vertex.RayDirection, Vertex.ConeRadius); TraveledDistance != Ray::NoIntersection) {
+					auto [HitPosition, HitNormal] = Ray::LocateSurface(DistanceField, *PointerToObjectRecord, Vertex.EyePoint, TraveledDistance, Vertex.RayDirection, Vertex.ConeRadius);
+					auto HitVertex = Vertex;
+					HitVertex.ConeRadius += Ray::PixelConeAngle * TraveledDistance;
+					SurfaceHits.push_back({ HitVertex, HitPosition, HitNormal, PointerToObjectRecord, HitPayload });
+				}
+				else
+					AccumulatedIntensities[Vertex.Pixel] += Vertex.Throughput * Ray::ShadeMiss(Vertex.EyePoint, Vertex.RayDirection);
+			}
+			Ray::ActiveRayQuality = {};
+			SecondaryRays.clear();
+		}
+		Ray::DeferredShadowRays = EnclosingShadowRays;
+		for (auto Index : Range{ GBuffer.Height * GBuffer.Width }) {
+			auto [y, x] = std::tuple{ Index / GBuffer.Width, Index % GBuffer.Width + static_cast<std::ptrdiff_t>(ColumnStart) };
+			Canvas[0][y][x] = AccumulatedIntensities[Index].x;
+			Canvas[1][y][x] = AccumulatedIntensities[Index].y;
+			Canvas[2][y][x] = AccumulatedIntensities[Index].z;
+		}
+	}
+}
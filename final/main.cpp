@@ -1,7 +1,13 @@
 #include <QApplication>
+#include <string_view>
 #include "mainwindow.h"
+#include "Canvas2D.h"
 
 auto main(int argc, char** argv)->int {
+    if (argc > 1 && std::string_view{ argv[1] } == "--benchmark") {
+        Canvas2D::runBenchmarks();
+        return 0;
+    }
     auto app = QApplication{ argc, argv };
     auto w = MainWindow{};
     w.show();
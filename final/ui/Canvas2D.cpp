@@ -29,8 +29,89 @@
 #include "../UniversalContext.hxx"
 #include "../RayMarching.hxx"
 #include "../Filter.hxx"
+#include "../Wavefront.hxx"
+#include "../ShadowMap.hxx"
+#include "../OcclusionCache.hxx"
+#include "../BrickMap.hxx"
+#include "../Benchmark.hxx"
 #include "distance_functions.hxx"
 
+namespace {
+    // Fills the supersampled columns [start, end) of the render, either by marching every sample on
+    // its own, through the two-stage deferred pipeline (G-buffer first, shading second), or through
+    // the wavefront pipeline that also queues secondary and shadow rays by generation. The marcher
+    // is compiled for the reflections and refractions the objects of the scene have.
+    auto RenderColumns(auto&& SupersampledRender, auto&& RayCaster, auto&& rayOrigin, auto Ks, auto Kt, auto&& DistanceField, auto&& Lights, auto&& InterruptHandler, int height, int start, int end, int Supersampling) {
+        auto SceneFeatures = Ray::DetectFeatures(*DistanceField.ObjectRecords, Lights);
+        Ray::DispatchFeatures<&Ray::SceneFeatures::Reflection, &Ray::SceneFeatures::Refraction>(SceneFeatures, [&]<Ray::SceneFeatures Features>() {
+            if (settings.useWavefrontRendering)
+                Wavefront::Render<Features>(SupersampledRender, rayOrigin, RayCaster, Ks, Kt, DistanceField, InterruptHandler, height, start, end, Supersampling);
+            else if (settings.useDeferredShading)
+                Deferred::Render<Features>(SupersampledRender, rayOrigin, RayCaster, Ks, Kt, DistanceField, InterruptHandler, height, start, end, Supersampling);
+            else
+                for (auto y : Range{ height })
+                    for (auto x = start; x < end; x++) {
+                        auto AccumulatedIntensity = Ray::March<Features>(rayOrigin, RayCaster(y, x), Ks, Kt, DistanceField, InterruptHandler, 1);
+                        SupersampledRender[0][y][x] = AccumulatedIntensity.x;
+                        SupersampledRender[1][y][x] = AccumulatedIntensity.y;
+                        SupersampledRender[2][y][x] = AccumulatedIntensity.z;
+                    }
+        });
+    }
+
+    // An illumination model compiled for the lights of the scene and for whether its objects receive shadows at all, as
+    // they are when it is configured; a scene lit only by directional lights never checks for the other kinds.
+    auto ConfigureSceneIlluminationModel(auto& Lights, auto Ka, auto Kd, auto Ks, auto& DistanceField, auto Hardness) {
+        auto IlluminationModel = decltype(DistanceField.ObjectRecords->front().IlluminationModel){};
+        auto SceneFeatures = Ray::DetectFeatures(*DistanceField.ObjectRecords, Lights);
+        Ray::DispatchFeatures<&Ray::SceneFeatures::Shadows, &Ray::SceneFeatures::OnlyDirectionalLights>(SceneFeatures, [&]<Ray::SceneFeatures Features>() {
+            IlluminationModel = Illuminations::ConfigureIlluminationModel<Features>(Lights, Ka, Kd, Ks, DistanceField, Hardness);
+        });
+        return IlluminationModel;
+    }
+
+    // Bakes the shadow maps of the directional lights over BoundingBox when they are enabled; every
+    // other light, and every surface outside the box, keeps marching its shadow rays.
+    auto PrepareShadowMaps(auto&& Lights, auto&& DistanceField, auto&& BoundingBox) {
+        if (settings.useShadowMaps)
+            Illuminations::ShadowLookup = Illuminations::LookUpShadowMaps(Illuminations::BuildShadowMaps(Lights, DistanceField, BoundingBox, settings.shadowMapResolution));
+    }
+
+    // A Mandelbulb, baked into a brick map over a box twice its scale around it when brick maps are enabled. Its
+    // record must declare the same Lipschitz bound. Maps are cached on disk by the parameters of the Mandelbulb,
+    // so only the first render of a scene pays for the bake.
+    auto PrepareMandelbulb(double Power, double Scale, const glm::vec4& Center, const glm::mat4& Rotation, double LipschitzBound) -> std::function<auto(const glm::vec4&)->double> {
+        auto Mandelbulb = CreateMandelbulb(Power, Scale, Center, Rotation);
+        if (!settings.useBrickMaps)
+            return Mandelbulb;
+        auto HalfExtent = glm::vec4{ glm::vec3{ 2 * static_cast<float>(Scale) }, 0 };
+        auto BoundingBox = std::tuple{ glm::vec4{ glm::vec3{ Center }, 1 } - HalfExtent, glm::vec4{ glm::vec3{ Center }, 1 } + HalfExtent };
+        return DistanceField::Bake(std::move(Mandelbulb), { .BoundingBox = BoundingBox, .LipschitzBound = LipschitzBound, .EnclosesSurface = true }, DistanceField::Fingerprint("Mandelbulb"sv, Power, Scale, Center, Rotation));
+    }
+
+    // The normal, and the depth and object index, of every supersample of the render in progress, which the
+    // deferred and wavefront pipelines keep for the denoiser to find edges by.
+    auto DenoiserGuides = std::tuple{ Filter::Frame<>{}, Filter::Frame<>{} };
+
+    auto PrepareDenoiserGuides(int height, int width) {
+        auto& [Normals, Geometry] = DenoiserGuides;
+        std::tie(Normals, Geometry) = std::tuple{ Filter::Frame{ height, width, 3 }, Filter::Frame{ height, width, 2 } };
+        Deferred::ExportGeometry = [&Normals = Normals, &Geometry = Geometry](std::ptrdiff_t y, std::ptrdiff_t x, double Depth, const glm::vec4& Normal, std::ptrdiff_t ObjectIndex) {
+            for (auto c : Range{ 3 })
+                Normals[c][y][x] = Normal[c];
+            Geometry[0][y][x] = Depth == Ray::NoIntersection ? 0. : Depth;
+            Geometry[1][y][x] = static_cast<double>(ObjectIndex);
+        };
+    }
+
+    // Denoises a finished supersampled render when the denoiser is enabled and its guides were kept.
+    auto Denoise(Filter::Frame<const double> SupersampledRender) {
+        if (auto& [Normals, Geometry] = DenoiserGuides; settings.useDenoiser && Normals.PlaneCount != 0)
+            return Filter::EdgeAvoidingWavelet(SupersampledRender, Normals, Geometry, settings.denoiserIterations, settings.denoiserColorTolerance);
+        return SupersampledRender;
+    }
+}
+
 Canvas2D::Canvas2D() {
     this->Width = this->m_image->width();
     this->Height = this->m_image->height();
@@ -179,6 +260,31 @@ void Canvas2D::renderImage(CS123SceneCameraData* camera, int width, int height)
 void Canvas2D::renderImage(CS123SceneCameraData*, int width, int height) {
     this->resize(width, height);
 
+    // Scene bounds, the background shader, shadow maps and the pixel footprint are per-render state; each scene sets its own.
+    Ray::SceneBoundingBox = Ray::UnboundedBox;
+    Illuminations::ShadowLookup = nullptr;
+    Illuminations::LookUpOcclusion = nullptr;
+    Illuminations::RecordOcclusion = nullptr;
+    if (settings.useOcclusionCache)
+        std::tie(Illuminations::LookUpOcclusion, Illuminations::RecordOcclusion) = Illuminations::ConfigureOcclusionCache(Illuminations::OcclusionCacheCapacity);
+    Ray::EnvironmentShader = nullptr;
+    Ray::PixelConeAngle = 0.;
+    Illuminations::StochasticLightSamples = settings.stochasticLightSamples;
+    Deferred::ExportGeometry = nullptr;
+    DenoiserGuides = {};
+    if (auto Supersampling = settings.useSuperSampling ? settings.numSuperSamples : 1; settings.useDenoiser && (settings.useDeferredShading || settings.useWavefrontRendering))
+        PrepareDenoiserGuides(height * Supersampling, width * Supersampling);
+    Ray::AmbientOcclusionTaps = settings.ambientOcclusionTaps;
+    Deferred::LowFrequencyShadingRate = settings.lowFrequencyShadingRate;
+    // Rays past the first bounce give up sooner and skip the shadows of dim paths, and from the second bounce on they also
+    // stop farther from surfaces. Their fractal detail is kept, as it shows plainly through glass.
+    Ray::SecondaryRayQualities.clear();
+    if (settings.useReducedSecondaryRayQuality)
+        Ray::SecondaryRayQualities = {
+            { .StepLimitScale = 0.25, .MinimumShadowedThroughput = 0.25 },
+            { .HitThresholdScale = 2., .StepLimitScale = 0.25, .MinimumShadowedThroughput = 0.25 },
+        };
+
 
     if (settings.renderSphere == settings.rendernumber) {
         this->renderSphere(width, height);
@@ -238,7 +344,7 @@ void Canvas2D::renderSphere(int width, int height) {
     auto Lights = std::vector<CS123SceneLightData>{};
 
     Ray::RelativeStepSizeForOcclusionEstimation = 0.1;
-    Ray::RelativeStepSizeForIntersection = 0.5;
+    Ray::SceneBoundingBox = std::tuple{ glm::vec4{ -Ray::Unbounded, -Ray::Unbounded, -Ray::Unbounded, 0 }, glm::vec4{ Ray::Unbounded, 4, Ray::Unbounded, 0 } };
 
     Lights.resize(2);
     Lights[0].type = LightType::LIGHT_DIRECTIONAL;
@@ -251,15 +357,18 @@ void Canvas2D::renderSphere(int width, int height) {
 
     using DistanceFunctionType = std::function<auto(const glm::vec4&)->double>;
     using IlluminationModelType = std::function<auto(const glm::vec4&, const glm::vec4&, const glm::vec4&, const CS123SceneMaterial&)->glm::vec4>;
-    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; };
+    using AnalyticIntersectionType = std::function<auto(const glm::vec4&, const glm::vec4&)->double>;
+    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; double LipschitzBound = 1.; AnalyticIntersectionType AnalyticIntersection; DistanceField::LightLinks LightLinks; };
 
     auto ObjectRecords = std::vector<ObjectRecordType>{};
     auto DistanceField = DistanceField::Synthesize(ObjectRecords);
-    auto GlobalIlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
+    auto GlobalIlluminationModel = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
 
     ObjectRecords.resize(3);
     //marker1
     ObjectRecords[0].DistanceFunction = CreateTerrain();
+    ObjectRecords[0].LipschitzBound = 1.25;
+    ObjectRecords[0].LightLinks.CachesShadowsFrom = DistanceField::AllLights;
     ObjectRecords[0].Material.cDiffuse = glm::vec4{ 0.4, 0.4, 0.6, 1 }; // mark
     ObjectRecords[0].Material.cAmbient = glm::vec4{ 0.1, 0.1, 0.1, 1 };
     ObjectRecords[0].Material.cSpecular = glm::vec4{ 0, 0, 0, 1 };
@@ -267,6 +376,7 @@ void Canvas2D::renderSphere(int width, int height) {
     ObjectRecords[0].IlluminationModel = GlobalIlluminationModel;
 
     ObjectRecords[1].DistanceFunction = CreateSphere(glm::vec4{ -1.5, 2.25, -3, 1 }, 1.5); // mark
+    ObjectRecords[1].AnalyticIntersection = CreateSphereIntersection(glm::vec4{ -1.5, 2.25, -3, 1 }, 1.5);
     ObjectRecords[1].Material.cDiffuse = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[1].Material.cAmbient = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[1].Material.cSpecular = glm::vec4{ 1, 1, 1, 1 };
@@ -279,6 +389,7 @@ void Canvas2D::renderSphere(int width, int height) {
     ObjectRecords[1].IlluminationModel = GlobalIlluminationModel;
 
     ObjectRecords[2].DistanceFunction = CreateSphere(glm::vec4{ 2, 0.25, -1, 1 }, 1.); // mark
+    ObjectRecords[2].AnalyticIntersection = CreateSphereIntersection(glm::vec4{ 2, 0.25, -1, 1 }, 1.);
     ObjectRecords[2].Material.cDiffuse = glm::vec4{ 1, 0, 0, 1 };
     ObjectRecords[2].Material.cAmbient = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[2].Material.cSpecular = glm::vec4{ 1, 1, 1, 1 };
@@ -296,7 +407,7 @@ void Canvas2D::renderSphere(int width, int height) {
     auto CreateThread = [=](auto&& SupersampledRender, auto&& SupersampledRayCaster, auto start, auto end, auto height) {
         auto ORCopy = ObjectRecords;
         auto DFCopy = DistanceField::Synthesize(ORCopy);
-        auto GIMCopy = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
+        auto GIMCopy = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
         for (auto i : Range{ ORCopy.size() })
             ORCopy[i].IlluminationModel = GIMCopy;
 
@@ -305,13 +416,7 @@ void Canvas2D::renderSphere(int width, int height) {
 
         };
         // Render each pixel
-        for (auto y : Range{ height })
-            for (auto x = start; x < end; x++) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, SupersampledRayCaster(y, x), Ks, Kt, DFCopy, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, SupersampledRayCaster, rayOrigin, Ks, Kt, DFCopy, Lights, InterruptHandler, height, start, end, Supersampling);
     };
 
     // Maximize thread usage
@@ -326,6 +431,7 @@ void Canvas2D::renderSphere(int width, int height) {
 
     auto SupersampledRender = Filter::Frame{ height * Supersampling, width * Supersampling, 3 };
     auto RayCaster = ViewPlane::ConfigureRayCaster(look, up, focalLength, height * Supersampling, width * Supersampling);
+    Ray::PixelConeAngle = ViewPlane::EstimatePixelConeAngle(focalLength, height * Supersampling);
 
     if (settings.useMultiThreading) {
         int ThreadWidth = width * Supersampling / MaxThreads;
@@ -340,16 +446,10 @@ void Canvas2D::renderSphere(int width, int height) {
         QThreadPool::globalInstance()->waitForDone();
     }
     else {
-        for (auto y : Range{ height * Supersampling })
-            for (auto x : Range{ width * Supersampling }) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, RayCaster(y, x), Ks, Kt, DistanceField, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, RayCaster, rayOrigin, Ks, Kt, DistanceField, Lights, InterruptHandler, height * Supersampling, 0, width * Supersampling, Supersampling);
     }
 
-    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(SupersampledRender.Finalize(), 1. / Supersampling)), 1. / Supersampling));
+    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(Denoise(SupersampledRender.Finalize()), 1. / Supersampling)), 1. / Supersampling));
     Filter::DisplayPort::Transfer(*this, ResampledRender);
 
     std::cout << "Done rendering." << std::endl;
@@ -390,7 +490,7 @@ void Canvas2D::rendermandelbulb(int width, int height) {
     auto Lights = std::vector<CS123SceneLightData>{};
 
     Ray::RelativeStepSizeForOcclusionEstimation = 0.1;
-    Ray::RelativeStepSizeForIntersection = 0.5;
+    Ray::SceneBoundingBox = std::tuple{ glm::vec4{ -Ray::Unbounded, -Ray::Unbounded, -Ray::Unbounded, 0 }, glm::vec4{ Ray::Unbounded, 4.5, Ray::Unbounded, 0 } };
 
     Lights.resize(3);
     Lights[0].type = LightType::LIGHT_DIRECTIONAL;
@@ -403,15 +503,19 @@ void Canvas2D::rendermandelbulb(int width, int height) {
 
     using DistanceFunctionType = std::function<auto(const glm::vec4&)->double>;
     using IlluminationModelType = std::function<auto(const glm::vec4&, const glm::vec4&, const glm::vec4&, const CS123SceneMaterial&)->glm::vec4>;
-    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; };
+    using AnalyticIntersectionType = std::function<auto(const glm::vec4&, const glm::vec4&)->double>;
+    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; double LipschitzBound = 1.; AnalyticIntersectionType AnalyticIntersection; DistanceField::LightLinks LightLinks; };
 
     auto ObjectRecords = std::vector<ObjectRecordType>{};
     auto DistanceField = DistanceField::Synthesize(ObjectRecords);
-    auto GlobalIlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
+    auto GlobalIlluminationModel = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
 
     ObjectRecords.resize(3);
     // marker4
     ObjectRecords[0].DistanceFunction = [](auto&& p) { return static_cast<double>(p.y); };
+    ObjectRecords[0].AnalyticIntersection = CreateXZPlaneIntersection(0.);
+    ObjectRecords[0].LightLinks.CastsShadowsFrom = DistanceField::NoLights;
+    ObjectRecords[0].LightLinks.CachesShadowsFrom = DistanceField::AllLights;
     ObjectRecords[0].Material.cDiffuse = glm::vec4{ 0.2, 0.2, 0.6, 1 };
     ObjectRecords[0].Material.cAmbient = glm::vec4{ 0.1, 0.1, 0.1, 1 };
     ObjectRecords[0].Material.cSpecular = glm::vec4{ 0.7, 0.7, 0.7, 1 };
@@ -423,7 +527,8 @@ void Canvas2D::rendermandelbulb(int width, int height) {
     auto rotate = glm::rotate(0.f, glm::vec3(1., 0., 0.));
 
 
-    ObjectRecords[1].DistanceFunction = CreateMandelbulb(16., 2, glm::vec4{ -1,2,-3,0 }, rotate);
+    ObjectRecords[1].DistanceFunction = PrepareMandelbulb(16., 2, glm::vec4{ -1,2,-3,0 }, rotate, 2.);
+    ObjectRecords[1].LipschitzBound = 2.;
     ObjectRecords[1].Material.cDiffuse = glm::vec4{ 1, 1, 0, 1 };
     ObjectRecords[1].Material.cAmbient = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[1].Material.cSpecular = glm::vec4{ 0.7, 0.7, 0.7, 1 };
@@ -434,7 +539,8 @@ void Canvas2D::rendermandelbulb(int width, int height) {
     rotate = glm::rotate(-1.1f, glm::vec3(1., 0., 0.));
 
 
-    ObjectRecords[2].DistanceFunction = CreateMandelbulb(8., 2, glm::vec4{ 2,2,1,0 }, rotate);
+    ObjectRecords[2].DistanceFunction = PrepareMandelbulb(8., 2, glm::vec4{ 2,2,1,0 }, rotate, 2.);
+    ObjectRecords[2].LipschitzBound = 2.;
     ObjectRecords[2].Material.cDiffuse = glm::vec4{ 1, 0, 0, 1 };
     ObjectRecords[2].Material.cAmbient = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[2].Material.shininess = 8;
@@ -460,9 +566,9 @@ void Canvas2D::rendermandelbulb(int width, int height) {
             return cosineColor(t, glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.01, 0.01, 0.01), glm::vec3(0.00, 0.15, 0.20));
         };
         // marker2
-        if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ObjectRecords[1])
+        if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ObjectRecords[1])
             ObjectMaterial.cDiffuse = glm::vec4{ 1.5f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition) }),1 }; // 2.0 for zoomed image
-        if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ObjectRecords[2])
+        if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ObjectRecords[2])
             ObjectMaterial.cDiffuse = glm::vec4{ 1.5f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition) }),1 };
 
     };
@@ -471,7 +577,7 @@ void Canvas2D::rendermandelbulb(int width, int height) {
     auto CreateThread = [=](auto&& SupersampledRender, auto&& SupersampledRayCaster, auto start, auto end, auto height) {
         auto ORCopy = ObjectRecords;
         auto DFCopy = DistanceField::Synthesize(ORCopy);
-        auto GIMCopy = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
+        auto GIMCopy = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
         for (auto i : Range{ ORCopy.size() })
             ORCopy[i].IlluminationModel = GIMCopy;
 
@@ -495,10 +601,10 @@ void Canvas2D::rendermandelbulb(int width, int height) {
                 return cosineColor(t, glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.01, 0.01, 0.01), glm::vec3(0.00, 0.15, 0.20));
             };
             //marker3
-            if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ORCopy[1])
+            if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ORCopy[1])
                 ObjectMaterial.cDiffuse = glm::vec4{ 1.5f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition) }),1 }; // 2.0 for zoomed image
 
-            if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ORCopy[2])
+            if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ORCopy[2])
                 ObjectMaterial.cDiffuse = glm::vec4{ 1.5f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition) }),1 };
 
 
@@ -506,13 +612,7 @@ void Canvas2D::rendermandelbulb(int width, int height) {
 
         };
         // Render each pixel
-        for (auto y : Range{ height })
-            for (auto x = start; x < end; x++) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, SupersampledRayCaster(y, x), Ks, Kt, DFCopy, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, SupersampledRayCaster, rayOrigin, Ks, Kt, DFCopy, Lights, InterruptHandler, height, start, end, Supersampling);
     };
 
     // Maximize thread usage
@@ -527,6 +627,7 @@ void Canvas2D::rendermandelbulb(int width, int height) {
 
     auto SupersampledRender = Filter::Frame{ height * Supersampling, width * Supersampling, 3 };
     auto RayCaster = ViewPlane::ConfigureRayCaster(look, up, focalLength, height * Supersampling, width * Supersampling);
+    Ray::PixelConeAngle = ViewPlane::EstimatePixelConeAngle(focalLength, height * Supersampling);
 
     if (settings.useMultiThreading) {
         int ThreadWidth = width * Supersampling / MaxThreads;
@@ -541,16 +642,10 @@ void Canvas2D::rendermandelbulb(int width, int height) {
         QThreadPool::globalInstance()->waitForDone();
     }
     else {
-        for (auto y : Range{ height * Supersampling })
-            for (auto x : Range{ width * Supersampling }) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, RayCaster(y, x), Ks, Kt, DistanceField, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, RayCaster, rayOrigin, Ks, Kt, DistanceField, Lights, InterruptHandler, height * Supersampling, 0, width * Supersampling, Supersampling);
     }
 
-    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(SupersampledRender.Finalize(), 1. / Supersampling)), 1. / Supersampling));
+    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(Denoise(SupersampledRender.Finalize()), 1. / Supersampling)), 1. / Supersampling));
     Filter::DisplayPort::Transfer(*this, ResampledRender);
 
     std::cout << "Done rendering." << std::endl;
@@ -586,7 +681,7 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
     auto Lights = std::vector<CS123SceneLightData>{};
 
     Ray::RelativeStepSizeForOcclusionEstimation = 0.1;
-    Ray::RelativeStepSizeForIntersection = 0.5;
+    Ray::SceneBoundingBox = std::tuple{ glm::vec4{ -7.25, -4.25, -9.25, 0 }, glm::vec4{ 5.25, 8.25, 3.25, 0 } };
 
     Lights.resize(3);
     Lights[0].type = LightType::LIGHT_DIRECTIONAL;
@@ -597,13 +692,17 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
     Lights[1].color = glm::vec4{ 0.5, 0.5, 0.5, 1. };
     Lights[1].dir = -look;
 
-    using DistanceFunctionType = std::function<auto(const glm::vec4&)->double>;
-    using IlluminationModelType = std::function<auto(const glm::vec4&, const glm::vec4&, const glm::vec4&, const CS123SceneMaterial&)->glm::vec4>;
-    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; };
+    // Deep zooms run out of float precision long before the marcher runs out of steps, so this
+    // render marches and evaluates its SDFs entirely in double.
+    using PrecisionPolicy = Precision::Double;
+    using DistanceFunctionType = std::function<auto(const glm::dvec4&)->double>;
+    using IlluminationModelType = std::function<auto(const glm::dvec4&, const glm::vec4&, const glm::vec4&, const CS123SceneMaterial&)->glm::vec4>;
+    using AnalyticIntersectionType = std::function<auto(const glm::vec4&, const glm::vec4&)->double>;
+    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; double LipschitzBound = 1.; AnalyticIntersectionType AnalyticIntersection; DistanceField::LightLinks LightLinks; };
 
     auto ObjectRecords = std::vector<ObjectRecordType>{};
-    auto DistanceField = DistanceField::Synthesize(ObjectRecords);
-    auto GlobalIlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
+    auto DistanceField = DistanceField::Synthesize<PrecisionPolicy>(ObjectRecords);
+    auto GlobalIlluminationModel = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
 
     ObjectRecords.resize(1);
     // marker4
@@ -613,6 +712,7 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
 
 
     ObjectRecords[0].DistanceFunction = CreateMandelbulb(16., 5, glm::vec4{ -1,2,-3,0 }, rotate);
+    ObjectRecords[0].LipschitzBound = 2.;
     ObjectRecords[0].Material.cDiffuse = glm::vec4{ 1, 1, 0, 1 };
     ObjectRecords[0].Material.cAmbient = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[0].Material.cSpecular = glm::vec4{ 0.7, 0.7, 0.7, 1 };
@@ -642,7 +742,7 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
             return cosineColor(t, glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.01, 0.01, 0.01), glm::vec3(0.00, 0.15, 0.20));
         };
         // marker2
-        if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ObjectRecords[0])
+        if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ObjectRecords[0])
             ObjectMaterial.cDiffuse = glm::vec4{ 2.0f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition) }),1 };
 
 
@@ -651,8 +751,8 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
     // Helper function to create a thread
     auto CreateThread = [=](auto&& SupersampledRender, auto&& SupersampledRayCaster, auto start, auto end, auto height) {
         auto ORCopy = ObjectRecords;
-        auto DFCopy = DistanceField::Synthesize(ORCopy);
-        auto GIMCopy = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
+        auto DFCopy = DistanceField::Synthesize<PrecisionPolicy>(ORCopy);
+        auto GIMCopy = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
         for (auto i : Range{ ORCopy.size() })
             ORCopy[i].IlluminationModel = GIMCopy;
 
@@ -676,7 +776,7 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
                 return cosineColor(t, glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.01, 0.01, 0.01), glm::vec3(0.00, 0.15, 0.20));
             };
             //marker3
-            if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ORCopy[0])
+            if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ORCopy[0])
                 ObjectMaterial.cDiffuse = glm::vec4{ 2.0f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition) }),1 }; //  for zoomed image
 
 
@@ -686,13 +786,7 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
 
         };
         // Render each pixel
-        for (auto y : Range{ height })
-            for (auto x = start; x < end; x++) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, SupersampledRayCaster(y, x), Ks, Kt, DFCopy, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, SupersampledRayCaster, rayOrigin, Ks, Kt, DFCopy, Lights, InterruptHandler, height, start, end, Supersampling);
     };
 
     // Maximize thread usage
@@ -707,6 +801,7 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
 
     auto SupersampledRender = Filter::Frame{ height * Supersampling, width * Supersampling, 3 };
     auto RayCaster = ViewPlane::ConfigureRayCaster(look, up, focalLength, height * Supersampling, width * Supersampling);
+    Ray::PixelConeAngle = ViewPlane::EstimatePixelConeAngle(focalLength, height * Supersampling);
 
     if (settings.useMultiThreading) {
         int ThreadWidth = width * Supersampling / MaxThreads;
@@ -721,16 +816,10 @@ void Canvas2D::rendermandelbulbzoomed(int width, int height) {
         QThreadPool::globalInstance()->waitForDone();
     }
     else {
-        for (auto y : Range{ height * Supersampling })
-            for (auto x : Range{ width * Supersampling }) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, RayCaster(y, x), Ks, Kt, DistanceField, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, RayCaster, rayOrigin, Ks, Kt, DistanceField, Lights, InterruptHandler, height * Supersampling, 0, width * Supersampling, Supersampling);
     }
 
-    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(SupersampledRender.Finalize(), 1. / Supersampling)), 1. / Supersampling));
+    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(Denoise(SupersampledRender.Finalize()), 1. / Supersampling)), 1. / Supersampling));
     Filter::DisplayPort::Transfer(*this, ResampledRender);
 
     std::cout << "Done rendering." << std::endl;
@@ -771,7 +860,7 @@ void Canvas2D::rendertree(int width, int height) {
 
 
     Ray::RelativeStepSizeForOcclusionEstimation = 0.1;
-    Ray::RelativeStepSizeForIntersection = 0.5;
+    Ray::SceneBoundingBox = std::tuple{ glm::vec4{ -Ray::Unbounded, -Ray::Unbounded, -Ray::Unbounded, 0 }, glm::vec4{ Ray::Unbounded, 10, Ray::Unbounded, 0 } };
 
     Lights.resize(2);
     Lights[0].type = LightType::LIGHT_DIRECTIONAL;
@@ -784,11 +873,12 @@ void Canvas2D::rendertree(int width, int height) {
 
     using DistanceFunctionType = std::function<auto(const glm::vec4&)->double>;
     using IlluminationModelType = std::function<auto(const glm::vec4&, const glm::vec4&, const glm::vec4&, const CS123SceneMaterial&)->glm::vec4>;
-    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; };
+    using AnalyticIntersectionType = std::function<auto(const glm::vec4&, const glm::vec4&)->double>;
+    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; double LipschitzBound = 1.; AnalyticIntersectionType AnalyticIntersection; DistanceField::LightLinks LightLinks; };
 
     auto ObjectRecords = std::vector<ObjectRecordType>{};
     auto DistanceField = DistanceField::Synthesize(ObjectRecords);
-    auto GlobalIlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
+    auto GlobalIlluminationModel = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
 
     ObjectRecords.resize(2);
 
@@ -800,6 +890,8 @@ void Canvas2D::rendertree(int width, int height) {
     ObjectRecords[0].IlluminationModel = GlobalIlluminationModel;
 
     ObjectRecords[1].DistanceFunction = CreateTerrain();
+    ObjectRecords[1].LipschitzBound = 1.25;
+    ObjectRecords[1].LightLinks.CachesShadowsFrom = DistanceField::AllLights;
     ObjectRecords[1].Material.cDiffuse = glm::vec4{ 0.4, 0.4, 0.4, 1 };
     ObjectRecords[1].Material.cAmbient = glm::vec4{ 0.1, 0.1, 0.1, 1 };
 
@@ -819,7 +911,7 @@ void Canvas2D::rendertree(int width, int height) {
 
 
     auto InterruptHandler = [&](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {
-        //if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ObjectRecords[ObjectRecords.size() - 1])
+        //if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ObjectRecords[ObjectRecords.size() - 1])
           //  ObjectMaterial.cDiffuse = SurfaceNormal;
     };
 
@@ -827,23 +919,17 @@ void Canvas2D::rendertree(int width, int height) {
     auto CreateThread = [=](auto&& SupersampledRender, auto&& SupersampledRayCaster, auto start, auto end, auto height) {
         auto ORCopy = ObjectRecords;
         auto DFCopy = DistanceField::Synthesize(ORCopy);
-        auto GIMCopy = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
+        auto GIMCopy = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
         for (auto i : Range{ ORCopy.size() })
             ORCopy[i].IlluminationModel = GIMCopy;
         //ORCopy[ORCopy.size() - 1].IlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, 25 * Hardness);
         // Custom Interrupt handler
         auto InterruptHandler = [&ORCopy](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {
-            // if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ORCopy[ORCopy.size() - 1])
+            // if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ORCopy[ORCopy.size() - 1])
                 // ObjectMaterial.cDiffuse = SurfaceNormal;
         };
         // Render each pixel
-        for (auto y : Range{ height })
-            for (auto x = start; x < end; x++) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, SupersampledRayCaster(y, x), Ks, Kt, DFCopy, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, SupersampledRayCaster, rayOrigin, Ks, Kt, DFCopy, Lights, InterruptHandler, height, start, end, Supersampling);
     };
 
     // Maximize thread usage
@@ -858,6 +944,7 @@ void Canvas2D::rendertree(int width, int height) {
 
     auto SupersampledRender = Filter::Frame{ height * Supersampling, width * Supersampling, 3 };
     auto RayCaster = ViewPlane::ConfigureRayCaster(look, up, focalLength, height * Supersampling, width * Supersampling);
+    Ray::PixelConeAngle = ViewPlane::EstimatePixelConeAngle(focalLength, height * Supersampling);
 
     if (settings.useMultiThreading) {
         int ThreadWidth = width * Supersampling / MaxThreads;
@@ -872,16 +959,10 @@ void Canvas2D::rendertree(int width, int height) {
         QThreadPool::globalInstance()->waitForDone();
     }
     else {
-        for (auto y : Range{ height * Supersampling })
-            for (auto x : Range{ width * Supersampling }) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, RayCaster(y, x), Ks, Kt, DistanceField, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, RayCaster, rayOrigin, Ks, Kt, DistanceField, Lights, InterruptHandler, height * Supersampling, 0, width * Supersampling, Supersampling);
     }
 
-    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(SupersampledRender.Finalize(), 1. / Supersampling)), 1. / Supersampling));
+    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(Denoise(SupersampledRender.Finalize()), 1. / Supersampling)), 1. / Supersampling));
     Filter::DisplayPort::Transfer(*this, ResampledRender);
 
     std::cout << "Done rendering." << std::endl;
@@ -918,7 +999,7 @@ void Canvas2D::renderepicscene1(int width, int height) {
     auto Lights = std::vector<CS123SceneLightData>{};
 
     Ray::RelativeStepSizeForOcclusionEstimation = 0.1;
-    Ray::RelativeStepSizeForIntersection = 0.5;
+    Ray::SceneBoundingBox = std::tuple{ glm::vec4{ -Ray::Unbounded, -Ray::Unbounded, -Ray::Unbounded, 0 }, glm::vec4{ Ray::Unbounded, 5.5, Ray::Unbounded, 0 } };
 
     Lights.resize(2);
     Lights[0].type = LightType::LIGHT_DIRECTIONAL;
@@ -938,30 +1019,29 @@ void Canvas2D::renderepicscene1(int width, int height) {
 
     using DistanceFunctionType = std::function<auto(const glm::vec4&)->double>;
     using IlluminationModelType = std::function<auto(const glm::vec4&, const glm::vec4&, const glm::vec4&, const CS123SceneMaterial&)->glm::vec4>;
-    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; };
+    using AnalyticIntersectionType = std::function<auto(const glm::vec4&, const glm::vec4&)->double>;
+    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; double LipschitzBound = 1.; AnalyticIntersectionType AnalyticIntersection; DistanceField::LightLinks LightLinks; };
 
     auto ObjectRecords = std::vector<ObjectRecordType>{};
     auto DistanceField = DistanceField::Synthesize(ObjectRecords);
-    auto GlobalIlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
-
-    auto ShadowRecords = std::vector<ObjectRecordType>{};
-    auto DistanceShadow = DistanceField::Synthesize(ShadowRecords);
-    ShadowRecords.resize(1);
+    auto GlobalIlluminationModel = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
 
     ObjectRecords.resize(3);
 
     auto rotate = glm::rotate(-1.1f, glm::vec3(1., 0., 0.));
 
 
-    ObjectRecords[0].DistanceFunction = CreateMandelbulb(16., 2, glm::vec4{ 0,3,4,0 }, rotate);
+    ObjectRecords[0].DistanceFunction = PrepareMandelbulb(16., 2, glm::vec4{ 0,3,4,0 }, rotate, 2.);
+    ObjectRecords[0].LipschitzBound = 2.;
     ObjectRecords[0].Material.cDiffuse = glm::vec4{ 1, 0, 0, 1 };
     ObjectRecords[0].Material.cAmbient = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[0].Material.shininess = 8;
-    ObjectRecords[0].IlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DistanceShadow, Hardness);
-
-    ShadowRecords[0] = ObjectRecords[0];
+    ObjectRecords[0].IlluminationModel = GlobalIlluminationModel;
+    // The mandelbulb only shadows itself; the sphere and the terrain sit in a caster group it does not receive from.
+    ObjectRecords[0].LightLinks.ShadowedByGroups = 1;
 
     ObjectRecords[1].DistanceFunction = CreateSphere(glm::vec4{ 0, 3, 0, 1 }, 0.7);
+    ObjectRecords[1].AnalyticIntersection = CreateSphereIntersection(glm::vec4{ 0, 3, 0, 1 }, 0.7);
     ObjectRecords[1].Material.cDiffuse = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[1].Material.cAmbient = glm::vec4{ 0, 0, 0, 1 };
     ObjectRecords[1].Material.cSpecular = glm::vec4{ 1, 1, 1, 1 };
@@ -972,13 +1052,17 @@ void Canvas2D::renderepicscene1(int width, int height) {
     ObjectRecords[1].Material.shininess = 32;
     ObjectRecords[1].Material.ior = 1.5;
     ObjectRecords[1].IlluminationModel = GlobalIlluminationModel;
+    ObjectRecords[1].LightLinks.CasterGroups = 2;
 
     ObjectRecords[2].DistanceFunction = CreateTerrain();
+    ObjectRecords[2].LipschitzBound = 1.25;
+    ObjectRecords[2].LightLinks.CachesShadowsFrom = DistanceField::AllLights;
     ObjectRecords[2].Material.cDiffuse = glm::vec4{ 0.4 * 1.5, 0.6 * 1.5, 0.4 * 1.5, 1 };
     ObjectRecords[2].Material.cAmbient = glm::vec4{ 0.1, 0.1, 0.1, 1 };
     ObjectRecords[2].Material.cSpecular = glm::vec4{ 0., 0., 0., 1 }; // marker
     ObjectRecords[2].Material.shininess = 32;
     ObjectRecords[2].IlluminationModel = GlobalIlluminationModel;
+    ObjectRecords[2].LightLinks.CasterGroups = 2;
 
 
 
@@ -1000,7 +1084,7 @@ void Canvas2D::renderepicscene1(int width, int height) {
             return cosineColor(t, glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.01, 0.01, 0.01), glm::vec3(0.00, 0.15, 0.20));
         };
 
-        if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ObjectRecords[0])
+        if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ObjectRecords[0])
             ObjectMaterial.cDiffuse = glm::vec4{ 1.2f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition - glm::vec4{0,4,0,0}) }),1 }; // marker
 
 
@@ -1009,19 +1093,11 @@ void Canvas2D::renderepicscene1(int width, int height) {
     // Helper function to create a thread
     auto CreateThread = [=](auto&& SupersampledRender, auto&& SupersampledRayCaster, auto start, auto end, auto height) {
         auto ORCopy = ObjectRecords;
-
-        auto SRCopy = ShadowRecords;
-        auto DSCopy = DistanceField::Synthesize(SRCopy);
-
-
         auto DFCopy = DistanceField::Synthesize(ORCopy);
-        auto GIMCopy = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
+        auto GIMCopy = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
         for (auto i : Range{ ORCopy.size() })
             ORCopy[i].IlluminationModel = GIMCopy;
 
-        ORCopy[0].IlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DSCopy, Hardness);
-        SRCopy[0] = ORCopy[0];
-
         // Custom Interrupt handler
         auto InterruptHandler = [&ORCopy](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {
 
@@ -1042,7 +1118,7 @@ void Canvas2D::renderepicscene1(int width, int height) {
                 return cosineColor(t, glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.5, 0.5, 0.5), glm::vec3(0.01, 0.01, 0.01), glm::vec3(0.00, 0.15, 0.20));
             };
 
-            if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ORCopy[0])
+            if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ORCopy[0])
                 ObjectMaterial.cDiffuse = glm::vec4{ 1.2f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition - glm::vec4{0,4,0,0}) }),1 }; // marker
 
 
@@ -1052,13 +1128,7 @@ void Canvas2D::renderepicscene1(int width, int height) {
 
         };
         // Render each pixel
-        for (auto y : Range{ height })
-            for (auto x = start; x < end; x++) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, SupersampledRayCaster(y, x), Ks, Kt, DFCopy, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, SupersampledRayCaster, rayOrigin, Ks, Kt, DFCopy, Lights, InterruptHandler, height, start, end, Supersampling);
     };
 
     // Maximize thread usage
@@ -1069,10 +1139,12 @@ void Canvas2D::renderepicscene1(int width, int height) {
     std::cout << "Number of threads being used: " << (settings.useMultiThreading ? MaxThreads : 1) << std::endl;
     auto start = std::chrono::steady_clock::now();
     std::string ThreadType = settings.useMultiThreading ? "Multithreaded: " : "Singlethreaded: ";
+    PrepareShadowMaps(Lights, DistanceField, std::tuple{ glm::vec4{ -15, -0.5, -4, 1 }, glm::vec4{ 15, 5.5, 25, 1 } });
 
 
     auto SupersampledRender = Filter::Frame{ height * Supersampling, width * Supersampling, 3 };
     auto RayCaster = ViewPlane::ConfigureRayCaster(look, up, focalLength, height * Supersampling, width * Supersampling);
+    Ray::PixelConeAngle = ViewPlane::EstimatePixelConeAngle(focalLength, height * Supersampling);
 
     if (settings.useMultiThreading) {
         int ThreadWidth = width * Supersampling / MaxThreads;
@@ -1087,16 +1159,10 @@ void Canvas2D::renderepicscene1(int width, int height) {
         QThreadPool::globalInstance()->waitForDone();
     }
     else {
-        for (auto y : Range{ height * Supersampling })
-            for (auto x : Range{ width * Supersampling }) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, RayCaster(y, x), Ks, Kt, DistanceField, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, RayCaster, rayOrigin, Ks, Kt, DistanceField, Lights, InterruptHandler, height * Supersampling, 0, width * Supersampling, Supersampling);
     }
 
-    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(SupersampledRender.Finalize(), 1. / Supersampling)), 1. / Supersampling));
+    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(Denoise(SupersampledRender.Finalize()), 1. / Supersampling)), 1. / Supersampling));
     Filter::DisplayPort::Transfer(*this, ResampledRender);
 
     std::cout << "Done rendering." << std::endl;
@@ -1136,7 +1202,7 @@ void Canvas2D::renderepicscene2(int width, int height) {
     auto Lights = std::vector<CS123SceneLightData>{};
 
     Ray::RelativeStepSizeForOcclusionEstimation = 0.1;
-    Ray::RelativeStepSizeForIntersection = 0.5;
+    Ray::SceneBoundingBox = std::tuple{ glm::vec4{ -Ray::Unbounded, -Ray::Unbounded, -100, 0 }, glm::vec4{ Ray::Unbounded, 24, Ray::Unbounded, 0 } };
 
     Lights.resize(2);
     Lights[0].type = LightType::LIGHT_DIRECTIONAL;
@@ -1149,14 +1215,15 @@ void Canvas2D::renderepicscene2(int width, int height) {
 
     using DistanceFunctionType = std::function<auto(const glm::vec4&)->double>;
     using IlluminationModelType = std::function<auto(const glm::vec4&, const glm::vec4&, const glm::vec4&, const CS123SceneMaterial&)->glm::vec4>;
-    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; };
+    using AnalyticIntersectionType = std::function<auto(const glm::vec4&, const glm::vec4&)->double>;
+    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; double LipschitzBound = 1.; AnalyticIntersectionType AnalyticIntersection; DistanceField::LightLinks LightLinks; };
 
     auto ObjectRecords = std::vector<ObjectRecordType>{};
     auto DistanceField = DistanceField::Synthesize(ObjectRecords);
-    auto GlobalIlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
+    auto GlobalIlluminationModel = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
 
 
-    ObjectRecords.resize(5);
+    ObjectRecords.resize(4);
 
     float rx = cos(1);
     float ry = sin(1);
@@ -1206,6 +1273,8 @@ void Canvas2D::renderepicscene2(int width, int height) {
 
 
     ObjectRecords[1].DistanceFunction = CreateTerrain();
+    ObjectRecords[1].LipschitzBound = 1.25;
+    ObjectRecords[1].LightLinks.CachesShadowsFrom = DistanceField::AllLights;
     ObjectRecords[1].Material.cDiffuse = glm::vec4{ 1, 1, 1, 1 };
     ObjectRecords[1].Material.cAmbient = glm::vec4{ 0.2, 0.2, 0.2, 1 };
     ObjectRecords[1].Material.shininess = 32;
@@ -1213,46 +1282,41 @@ void Canvas2D::renderepicscene2(int width, int height) {
 
 
 
-    ObjectRecords[4].DistanceFunction = [](auto&& p) { return static_cast<double>(p.z) + 100; };
-    ObjectRecords[4].Material.cDiffuse = glm::vec4{ 0., 0., 0., 1 };
-    ObjectRecords[4].Material.cAmbient = glm::vec4{ 0.5, 0.83, 1, 1 };
-    ObjectRecords[4].Material.cSpecular = glm::vec4{ 0.25, 0.25, 0.25, 1 };
-    ObjectRecords[4].Material.shininess = 32;
-    ObjectRecords[4].IlluminationModel = GlobalIlluminationModel;
+    // The sky is the z = -100 backdrop, lit without shadows; it is looked up analytically when a ray
+    // leaves the scene bounds instead of being marched to.
+    Ray::EnvironmentShader = [=](auto&& EyePoint, auto&& RayDirection) {
+        if (RayDirection.z >= 0)
+            return glm::vec4{ 0, 0, 0, 0 };
+        auto BackdropPosition = EyePoint + (-100 - EyePoint.z) / RayDirection.z * RayDirection;
+        auto BackdropNormal = glm::vec4{ 0, 0, 1, 0 };
+        auto BackdropDiffuse = glm::vec4{ 1.5f * glm::normalize(glm::vec3{ glm::abs(BackdropPosition) }), 1 };
+        auto AccumulatedIntensity = Ka * glm::vec4{ 0.5, 0.83, 1, 1 };
+        for (auto&& Light : Lights) {
+            auto LightDirection = glm::normalize(Light.dir);
+            AccumulatedIntensity += Illuminations::Diffuse(LightDirection, BackdropNormal, Light.color, Kd * BackdropDiffuse);
+            AccumulatedIntensity += Illuminations::Specular(LightDirection, BackdropNormal, -RayDirection, Light.color, Ks * glm::vec4{ 0.25, 0.25, 0.25, 1 }, 32.f);
+        }
+        return AccumulatedIntensity;
+    };
 
 
 
 
 
-    auto InterruptHandler = [&](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {
-        if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ObjectRecords[4])
-            ObjectMaterial.cDiffuse = glm::vec4{ 1.5f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition) }),1 };
-    };
+    auto InterruptHandler = [](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {};
 
     // Helper function to create a thread
     auto CreateThread = [=](auto&& SupersampledRender, auto&& SupersampledRayCaster, auto start, auto end, auto height) {
         auto ORCopy = ObjectRecords;
         auto DFCopy = DistanceField::Synthesize(ORCopy);
-        auto GIMCopy = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
+        auto GIMCopy = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
         for (auto i : Range{ ORCopy.size() })
             ORCopy[i].IlluminationModel = GIMCopy;
         //ORCopy[ORCopy.size() - 1].IlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, 25 * Hardness);
         // Custom Interrupt handler
-        auto InterruptHandler = [&ORCopy](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {
-            if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ORCopy[4])
-                ObjectMaterial.cDiffuse = glm::vec4{ 1.5f * glm::normalize(glm::vec3{ glm::abs(SurfacePosition) }),1 };
-        };
+        auto InterruptHandler = [](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {};
         // Render each pixel
-        for (auto y : Range{ height }) {
-
-            std::cout << y << " " << height << std::endl;
-            for (auto x = start; x < end; x++) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, SupersampledRayCaster(y, x), Ks, Kt, DFCopy, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
-        }
+        RenderColumns(SupersampledRender, SupersampledRayCaster, rayOrigin, Ks, Kt, DFCopy, Lights, InterruptHandler, height, start, end, Supersampling);
     };
 
     // Maximize thread usage
@@ -1263,10 +1327,12 @@ void Canvas2D::renderepicscene2(int width, int height) {
     std::cout << "Number of threads being used: " << (settings.useMultiThreading ? MaxThreads : 1) << std::endl;
     auto start = std::chrono::steady_clock::now();
     std::string ThreadType = settings.useMultiThreading ? "Multithreaded: " : "Singlethreaded: ";
+    PrepareShadowMaps(Lights, DistanceField, std::tuple{ glm::vec4{ -40, -1, -40, 0 }, glm::vec4{ 20, 24, 18, 0 } });
 
 
     auto SupersampledRender = Filter::Frame{ height * Supersampling, width * Supersampling, 3 };
     auto RayCaster = ViewPlane::ConfigureRayCaster(look, up, focalLength, height * Supersampling, width * Supersampling);
+    Ray::PixelConeAngle = ViewPlane::EstimatePixelConeAngle(focalLength, height * Supersampling);
 
     if (settings.useMultiThreading) {
         int ThreadWidth = width * Supersampling / MaxThreads;
@@ -1281,16 +1347,10 @@ void Canvas2D::renderepicscene2(int width, int height) {
         QThreadPool::globalInstance()->waitForDone();
     }
     else {
-        for (auto y : Range{ height * Supersampling })
-            for (auto x : Range{ width * Supersampling }) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, RayCaster(y, x), Ks, Kt, DistanceField, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, RayCaster, rayOrigin, Ks, Kt, DistanceField, Lights, InterruptHandler, height * Supersampling, 0, width * Supersampling, Supersampling);
     }
 
-    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(SupersampledRender.Finalize(), 1. / Supersampling)), 1. / Supersampling));
+    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(Denoise(SupersampledRender.Finalize()), 1. / Supersampling)), 1. / Supersampling));
     Filter::DisplayPort::Transfer(*this, ResampledRender);
 
     std::cout << "Done rendering." << std::endl;
@@ -1344,7 +1404,7 @@ void Canvas2D::renderforest(int width, int height) {
     auto fractalWidth = 0.2;
 
     Ray::RelativeStepSizeForOcclusionEstimation = 0.1;
-    Ray::RelativeStepSizeForIntersection = 0.5;
+    Ray::SceneBoundingBox = std::tuple{ glm::vec4{ -Ray::Unbounded, -Ray::Unbounded, -51, 0 }, glm::vec4{ Ray::Unbounded, 10, Ray::Unbounded, 0 } };
 
     Lights.resize(2);
     Lights[0].type = LightType::LIGHT_DIRECTIONAL;
@@ -1357,21 +1417,26 @@ void Canvas2D::renderforest(int width, int height) {
 
     using DistanceFunctionType = std::function<auto(const glm::vec4&)->double>;
     using IlluminationModelType = std::function<auto(const glm::vec4&, const glm::vec4&, const glm::vec4&, const CS123SceneMaterial&)->glm::vec4>;
-    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; };
+    using AnalyticIntersectionType = std::function<auto(const glm::vec4&, const glm::vec4&)->double>;
+    using ObjectRecordType = struct { DistanceFunctionType DistanceFunction; CS123SceneMaterial Material; IlluminationModelType IlluminationModel; double LipschitzBound = 1.; AnalyticIntersectionType AnalyticIntersection; DistanceField::LightLinks LightLinks; };
 
     auto ObjectRecords = std::vector<ObjectRecordType>{};
     auto DistanceField = DistanceField::Synthesize(ObjectRecords);
-    auto GlobalIlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
+    auto GlobalIlluminationModel = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DistanceField, Hardness);
 
     ObjectRecords.resize(13);
 
     ObjectRecords[0].DistanceFunction = CreateTerrain();
+    ObjectRecords[0].LipschitzBound = 1.25;
+    ObjectRecords[0].LightLinks.CachesShadowsFrom = DistanceField::AllLights;
     ObjectRecords[0].Material.cDiffuse = glm::vec4{ 0.457, 0.16, 0.05, 1 };
     ObjectRecords[0].Material.cAmbient = glm::vec4{ 0.1, 0.1, 0.1, 1 };
     ObjectRecords[0].Material.shininess = 32;
     ObjectRecords[0].IlluminationModel = GlobalIlluminationModel;
 
     ObjectRecords[1].DistanceFunction = [](auto&& p) { return static_cast<double>(p.z) + 50; };
+    ObjectRecords[1].AnalyticIntersection = CreateXYPlaneIntersection(-50.);
+    ObjectRecords[1].LightLinks.CastsShadowsFrom = DistanceField::NoLights;
     ObjectRecords[1].Material.cDiffuse = glm::vec4{ 0., 0., 0., 1 };
     ObjectRecords[1].Material.cAmbient = glm::vec4{ 0.05, 0.05, 0.05, 1 };
     ObjectRecords[1].Material.cSpecular = glm::vec4{ 0.25, 0.25, 0.25, 1 };
@@ -1481,7 +1546,7 @@ void Canvas2D::renderforest(int width, int height) {
     //    ObjectRecords[13].IlluminationModel = GlobalIlluminationModel;
 
     auto InterruptHandler = [&](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {
-        //if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ObjectRecords[ObjectRecords.size() - 1])
+        //if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ObjectRecords[ObjectRecords.size() - 1])
           //  ObjectMaterial.cDiffuse = SurfaceNormal;
     };
 
@@ -1489,23 +1554,17 @@ void Canvas2D::renderforest(int width, int height) {
     auto CreateThread = [=](auto&& SupersampledRender, auto&& SupersampledRayCaster, auto start, auto end, auto height) {
         auto ORCopy = ObjectRecords;
         auto DFCopy = DistanceField::Synthesize(ORCopy);
-        auto GIMCopy = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
+        auto GIMCopy = ConfigureSceneIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, Hardness);
         for (auto i : Range{ ORCopy.size() })
             ORCopy[i].IlluminationModel = GIMCopy;
         //ORCopy[ORCopy.size() - 1].IlluminationModel = Illuminations::ConfigureIlluminationModel(Lights, Ka, Kd, Ks, DFCopy, 25 * Hardness);
         // Custom Interrupt handler
         auto InterruptHandler = [&ORCopy](auto&& SurfacePosition, auto&& SurfaceNormal, auto&& ObjectRecord) {
-            // if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ORCopy[ORCopy.size() - 1])
+            // if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ORCopy[ORCopy.size() - 1])
                 // ObjectMaterial.cDiffuse = SurfaceNormal;
         };
         // Render each pixel
-        for (auto y : Range{ height })
-            for (auto x = start; x < end; x++) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, SupersampledRayCaster(y, x), Ks, Kt, DFCopy, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, SupersampledRayCaster, rayOrigin, Ks, Kt, DFCopy, Lights, InterruptHandler, height, start, end, Supersampling);
     };
 
     // Maximize thread usage
@@ -1516,10 +1575,12 @@ void Canvas2D::renderforest(int width, int height) {
     std::cout << "Number of threads being used: " << (settings.useMultiThreading ? MaxThreads : 1) << std::endl;
     auto start = std::chrono::steady_clock::now();
     std::string ThreadType = settings.useMultiThreading ? "Multithreaded: " : "Singlethreaded: ";
+    PrepareShadowMaps(Lights, DistanceField, std::tuple{ glm::vec4{ -20, -1, -51, 0 }, glm::vec4{ 20, 10, 18, 0 } });
 
 
     auto SupersampledRender = Filter::Frame{ height * Supersampling, width * Supersampling, 3 };
     auto RayCaster = ViewPlane::ConfigureRayCaster(look, up, focalLength, height * Supersampling, width * Supersampling);
+    Ray::PixelConeAngle = ViewPlane::EstimatePixelConeAngle(focalLength, height * Supersampling);
 
     if (settings.useMultiThreading) {
         int ThreadWidth = width * Supersampling / MaxThreads;
@@ -1534,16 +1595,10 @@ void Canvas2D::renderforest(int width, int height) {
         QThreadPool::globalInstance()->waitForDone();
     }
     else {
-        for (auto y : Range{ height * Supersampling })
-            for (auto x : Range{ width * Supersampling }) {
-                auto AccumulatedIntensity = Ray::March(rayOrigin, RayCaster(y, x), Ks, Kt, DistanceField, InterruptHandler, 1);
-                SupersampledRender[0][y][x] = AccumulatedIntensity.x;
-                SupersampledRender[1][y][x] = AccumulatedIntensity.y;
-                SupersampledRender[2][y][x] = AccumulatedIntensity.z;
-            }
+        RenderColumns(SupersampledRender, RayCaster, rayOrigin, Ks, Kt, DistanceField, Lights, InterruptHandler, height * Supersampling, 0, width * Supersampling, Supersampling);
     }
 
-    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(SupersampledRender.Finalize(), 1. / Supersampling)), 1. / Supersampling));
+    auto ResampledRender = Filter::Transpose(Filter::HorizontalScale(Filter::Transpose(Filter::HorizontalScale(Denoise(SupersampledRender.Finalize()), 1. / Supersampling)), 1. / Supersampling));
     Filter::DisplayPort::Transfer(*this, ResampledRender);
 
     std::cout << "Done rendering." << std::endl;
@@ -1574,6 +1629,32 @@ void Canvas2D::cancelRender() {
     // TODO: cancel the raytracer (optional)
 }
 
+void Canvas2D::runBenchmarks() {
+    // Primary rays of the zoomed Mandelbulb, marched under every precision policy.
+    auto iTime = 4200;
+    auto rayOrigin = 1.45f * glm::vec4{ 6.0 * std::sin(iTime * .3), 4.8, 6.0 * std::cos(iTime * .3), 1 };
+    auto look = glm::normalize(rayOrigin - glm::vec4{ 0, 0, 0, 1 });
+    auto RayCaster = ViewPlane::ConfigureRayCaster(look, glm::vec4{ 0, 1, 0, 0 }, 2., 240, 320);
+    auto Mandelbulb = CreateMandelbulb(16., 5, glm::vec4{ -1,2,-3,0 }, glm::rotate(0.f, glm::vec3(1., 0., 0.)));
+    std::cout << "Intersection throughput, zoomed Mandelbulb at 320x240:" << std::endl;
+    for (auto&& [Name, Result] : Benchmark::ComparePrecisionPolicies(Mandelbulb, rayOrigin, RayCaster, 240, 320)) {
+        auto [RaysPerSecond, Hits] = Result;
+        std::cout << "    " << Name << ": " << RaysPerSecond / 1e3 << "k rays/s, " << Hits << " hits" << std::endl;
+    }
+
+    // The fast transcendentals against libm, one call at a time and in batches of 8.
+    std::cout << "Fast math against libm, in M calls/s:" << std::endl;
+    for (auto&& [Name, AbsoluteError, RelativeError, Fast, Reference, FastBatch, ReferenceBatch] : Benchmark::CompareFastMath(1 << 20, 20))
+        std::cout << "    " << Name << ": max error " << AbsoluteError << " (relative " << RelativeError << "), " << Fast / 1e6 << " against " << Reference / 1e6 << ", x8 " << FastBatch / 1e6 << " against " << ReferenceBatch / 1e6 << std::endl;
+
+    // The tabulated gradient noise against glm::perlin, at the terrain's two octaves and at a deeper five.
+    std::cout << "Gradient noise against glm::perlin, in M samples/s:" << std::endl;
+    for (auto Octaves : { 2, 5 }) {
+        auto [Mismatches, Reference, Tabulated, TabulatedX8, TabulatedX16] = Benchmark::CompareGradientNoise({ .Octaves = Octaves }, 1 << 18, 10);
+        std::cout << "    " << Octaves << " octaves: " << Mismatches << " mismatches, " << Reference / 1e6 << " against " << Tabulated / 1e6 << ", x8 " << TabulatedX8 / 1e6 << ", x16 " << TabulatedX16 / 1e6 << std::endl;
+    }
+}
+
 /* Fractal Tree
     int leaf=0;
     ObjectRecords[2].DistanceFunction = [&](auto&& p) {
@@ -1634,7 +1715,7 @@ void Canvas2D::cancelRender() {
         else
             ORCopy[2].Material.cDiffuse = glm::vec4{ 165.0/255.0, 42.0/255.0, 42.0/255.0, 1 };
 
-        if (auto& [_, ObjectMaterial, __] = ObjectRecord; &ObjectRecord == &ORCopy[ORCopy.size() - 1])
+        if (auto& [_, ObjectMaterial, __, ___, ____, _____] = ObjectRecord; &ObjectRecord == &ORCopy[ORCopy.size() - 1])
             ObjectMaterial.cDiffuse = SurfaceNormal;
     };
 
@@ -34,6 +34,10 @@ public:
     void renderepicscene2( int width, int height);
     void renderforest( int width, int height);
 
+    // Times the marcher under each precision policy, the fast math against libm and the tabulated noise against glm::perlin,
+    // and prints the results; main() runs this for --benchmark.
+    static void runBenchmarks();
+
     // This will be called when the settings have changed
     virtual void settingsChanged();
 
@@ -150,6 +150,20 @@ struct Settings {
     int mandelzoom= SHAPE_SPECIAL_1;
     int forest_scene= SHAPE_SPECIAL_2;
 
+    bool useDeferredShading = true;   // March primary rays into a G-buffer, then shade it in a second pass.
+    bool useWavefrontRendering = false;   // Queue rays by generation and march each sorted queue as a batch.
+    bool useShadowMaps = false;   // Look shadows of directional lights up in maps baked before the render.
+    int shadowMapResolution = 1024;   // Texels along each side of a shadow map.
+    bool useOcclusionCache = false;   // Share soft shadows between nearby points of surfaces that allow it; off evaluates every shadow exactly.
+    bool useBrickMaps = false;   // March the Mandelbulbs through sparse brick maps baked once and cached on disk, evaluating them exactly only near their surfaces.
+    int stochasticLightSamples = 0;   // Shade each point with this many of the lights reaching it, drawn by brightness; 0 shades with all of them.
+    int ambientOcclusionTaps = 5;   // Distance-field samples along the normal that darken the ambient term in creases; 0 leaves it unoccluded.
+    int lowFrequencyShadingRate = 1;   // With deferred or wavefront rendering, evaluate soft shadows and ambient occlusion at every n-th sample along each axis and interpolate the rest; 1 evaluates them everywhere.
+    bool useDenoiser = false;   // Filter the supersampled render around the edges kept by deferred or wavefront rendering before it is downsampled.
+    int denoiserIterations = 4;   // Each iteration doubles the footprint of the denoiser.
+    float denoiserColorTolerance = 0.5f;   // Color differences well past this are kept as edges by the denoiser.
+    bool useReducedSecondaryRayQuality = true;   // Trace reflected and refracted rays with fewer steps, a looser hit threshold and no shadows on dim paths.
+
 };
 
 // The global Settings object, will be initialized by MainWindow
@@ -1,128 +1,169 @@
 #pragma once
-#include <glm/gtc/noise.hpp>
 #include "Settings.h"
 #include "../RayMarching.hxx"
+#include "../FastMath.hxx"
+#include "../Noise.hxx"
 
 
 
-constexpr auto CreateSphere = [](auto&& Center, auto Radius) {
-    return[=, Center = Forward(Center)](auto&& Position) { return glm::length(Position - Center) - Radius; };
+// How many levels of a fractal are worth evaluating under the current ray's footprint, when the
+// structure grown from the first level spans Extent and every further level shrinks it by Shrink.
+// Levels whose whole substructure fits inside the footprint are dropped. The result is fractional
+// so the fractal can blend between its two neighbouring levels instead of popping.
+constexpr auto EstimateDetailLevels = [](auto Extent, auto Shrink, auto MaximumLevels) {
+    if (DistanceField::Footprint <= 0)
+        return static_cast<double>(MaximumLevels);
+    auto Levels = std::log(Extent / DistanceField::Footprint) / std::log(Shrink) + 2;
+    return std::clamp(Levels, std::min(1., static_cast<double>(MaximumLevels)), static_cast<double>(MaximumLevels));
 };
 
-constexpr auto CreateMandelbulb = [](auto Power, auto scale, auto&& Center, auto&& rotation_matrix) {
-
-
-    return[=, Center = Forward(Center), rotation_matrix = Forward(rotation_matrix)](auto&& p) {
-
-        auto ro = [](auto&& a) {
-            float s = sin(a), c = cos(a);
-            return glm::mat2(c, -s, s, c);
-        };
-
-
-
-        auto pos = p - Center;
+constexpr auto CreateSphere = [](auto&& Center, auto Radius) {
+    return[=, Center = Forward(Center)](auto&& Position) {
+        using Scalar = Precision::ScalarOf<decltype(Position)>;
+        return glm::length(Position - Precision::Vector4<Scalar>{ Center }) - static_cast<Scalar>(Radius);
+    };
+};
 
-        pos = static_cast<float>(1. / scale) * pos;
-        pos = glm::inverse(rotation_matrix) * pos;
+constexpr auto CreateSphereIntersection = [](auto&& Center, auto Radius) {
+    return[=, Center = Forward(Center)](auto&& EyePoint, auto&& RayDirection) {
+        auto [Origin, Direction] = std::tuple{ glm::vec3{ EyePoint - Center }, glm::vec3{ RayDirection } };
+        auto [a, b, c] = std::tuple{ glm::dot(Direction, Direction), 2 * glm::dot(Direction, Origin), glm::dot(Origin, Origin) - static_cast<float>(Radius * Radius) };
+        auto [t, _, __, ___] = ImplicitFunctions::Solvers::Quadratic(Origin, Direction, a, b, c, [](auto...) { return true; }, [](auto&&) { return std::tuple{ 0., 0. }; });
+        return t;
+    };
+};
 
+constexpr auto CreateXZPlaneIntersection = [](auto y) {
+    return[=](auto&& EyePoint, auto&& RayDirection) {
+        if (auto [t, _, __] = ImplicitFunctions::Solvers::XZPlane(EyePoint, RayDirection, static_cast<double>(y), [](auto...) { return true; }); t >= 0)
+            return static_cast<double>(t);
+        return Ray::NoIntersection;
+    };
+};
 
+constexpr auto CreateXYPlaneIntersection = [](auto z) {
+    return[=](auto&& EyePoint, auto&& RayDirection) {
+        if (auto [t, _, __] = ImplicitFunctions::Solvers::XYPlane(EyePoint, RayDirection, static_cast<double>(z), [](auto...) { return true; }); t >= 0)
+            return static_cast<double>(t);
+        return Ray::NoIntersection;
+    };
+};
 
-        auto z = glm::vec3{ pos };
-        auto dr = 1.0;
-        auto r = 0.0;
-        for (auto _ : Range{ 5 }) {
+constexpr auto CreateMandelbulb = [](auto Power, auto scale, auto&& Center, auto&& rotation_matrix, auto... MathPolicy) {
+    using Math = FastMath::Select<decltype(MathPolicy)...>;
+    return DistanceField::Transform([=](auto&& pos) {
+        using Scalar = Precision::ScalarOf<decltype(pos)>;
+        auto z = Precision::Vector3<Scalar>{ pos };
+        auto Exponent = static_cast<Scalar>(Power);
+        auto dr = Scalar{ 1 };
+        auto r = Scalar{ 0 };
+        auto EstimateDistance = [&] { return static_cast<Scalar>(0.5) * Math::Log(r) * r / dr; };
+        auto Levels = EstimateDetailLevels(1., Power, 5);
+        auto [CoarseLevels, FineLevels] = std::tuple{ static_cast<int>(std::floor(Levels)), static_cast<int>(std::ceil(Levels)) };
+        auto [CompletedLevels, CoarseDistance, OrbitTrap] = std::tuple{ 0, Scalar{ 0 }, std::numeric_limits<Scalar>::infinity() };
+        for (auto _ : Range{ FineLevels }) {
             r = glm::length(z);
-            if (r > 4.) break;
+            OrbitTrap = std::min(OrbitTrap, r * r);
+            if (r > 4) break;
             // convert to polar coordinates
-            auto theta = std::acos(z.z / r);
-            auto phi = std::atan2(z.y, z.x);
-            dr = std::pow(r, Power - 1) * Power * dr + 1;
+            auto theta = Math::Acos(z.z / r);
+            auto phi = Math::Atan2(z.y, z.x);
+            dr = Math::Pow(r, Exponent - 1) * Exponent * dr + 1;
 
             // scale and rotate the point
-            auto zr = static_cast<float>(std::pow(r, Power));
-            theta = theta * Power;
-            phi = phi * Power;
+            auto zr = Math::Pow(r, Exponent);
+            theta = theta * Exponent;
+            phi = phi * Exponent;
 
             // convert back to cartesian coordinates
-            z = zr * glm::vec3{
-                std::sin(theta) * std::cos(phi),
-                std::sin(phi) * std::sin(theta),
-                std::cos(theta) };
-            z += glm::vec3{ pos };
+            z = zr * Precision::Vector3<Scalar>{
+                Math::Sin(theta) * Math::Cos(phi),
+                Math::Sin(phi) * Math::Sin(theta),
+                Math::Cos(theta) };
+            z += Precision::Vector3<Scalar>{ pos };
+            if (++CompletedLevels == CoarseLevels)
+                CoarseDistance = EstimateDistance();
         }
-        return scale * 0.5 * std::log(r) * r / dr;
-    };
-
-
+        DistanceField::Auxiliary.OrbitTrap = static_cast<float>(OrbitTrap);
+        DistanceField::Auxiliary.EscapeIteration = static_cast<float>(CompletedLevels);
+        if (CompletedLevels < CoarseLevels || CoarseLevels == FineLevels)
+            return EstimateDistance();
+        return CoarseDistance + static_cast<Scalar>(Levels - CoarseLevels) * (EstimateDistance() - CoarseDistance);
+    }, Center, rotation_matrix, scale);
 };
 
-constexpr auto CreateTerrain = []() {
+constexpr auto CreateTerrain = [](GradientNoise::Fractal Noise = {}, auto... MathPolicy) {
+    using Math = FastMath::Select<decltype(MathPolicy)...>;
 
     return [=](auto&& p) {
-        if (p.y > 1.05f) {
-            return static_cast<double>(p.y);
+        using Scalar = Precision::ScalarOf<decltype(p)>;
+        // the noise never exceeds 0.98, so no part of the surface rises above 0.72; closer to it than this,
+        // skipping the noise understates the distance enough to darken soft shadows
+        if (p.y > static_cast<Scalar>(5)) {
+            return p.y - static_cast<Scalar>(0.75);
         }
         else {
-            auto noise = glm::perlin(0.5f * p.xz()) + 0.5 * glm::perlin(0.75f * p.xz());
-            noise /= 1.5;
+            auto noise = GradientNoise::FractalSum(Noise, p.x, p.z);
             // ridges or no?
 //            noise = glm::round(noise * 8) / 8.f;
-            noise = 1.f / (1 + std::exp(-(2 * noise - 1)));
-            return static_cast<double>(p.y - noise);
+            noise = 1 / (1 + Math::Exp(-(2 * noise - 1)));
+            return p.y - noise;
         }
     };
 
 };
 
 constexpr auto CreateTree = [](auto depth, auto height, auto width, auto rxy, auto rzx, auto&& Center) {
-
-
-
-
+    auto [sxy, cxy, szx, czx] = std::tuple{ std::sin(rxy), std::cos(rxy), std::sin(rzx), std::cos(rzx) };
 
     return[=, Center = Forward(Center)](auto&& p) {
+        using Scalar = Precision::ScalarOf<decltype(p)>;
 
         auto ln = [](auto&& p, auto&& a, auto&& b, auto&& R) {
-            double r = glm::dot(p - a, b - a) / glm::dot(b - a, b - a);
-            r = std::clamp(r, 0., 1.);
-            return glm::length(p - a - (float)r * (b - a)) - R * (1.5 - 0.4 * r);
+            auto r = glm::dot(p - a, b - a) / glm::dot(b - a, b - a);
+            r = std::clamp(r, Scalar{ 0 }, Scalar{ 1 });
+            return glm::length(p - a - r * (b - a)) - R * (static_cast<Scalar>(1.5) - static_cast<Scalar>(0.4) * r);
         };
-        auto ro = [](auto&& a) {
-            float s = sin(a), c = cos(a);
-            return glm::mat2(c, -s, s, c);
+        auto ro = [](auto&& sa, auto&& ca) {
+            Scalar s = sa, c = ca;
+            return Precision::Matrix2<Scalar>(c, -s, s, c);
         };
 
-        double l = glm::length(p);
-        auto pos = p;
+        Scalar l = glm::length(p);
+        auto pos = Precision::Vector4<Scalar>{ p };
 
         pos.x -= Center.x;
         pos.y -= Center.y;
         pos.z -= Center.z;
-        float pi = 3.14159;
         //pos.xz *= 1.;
-        glm::vec2 rl = glm::vec2(width, height);
-        //        leaf=0;
-        for (int i = 1; i < depth; i++) {
-            l = std::min(l, ln(pos, glm::vec4(0), glm::vec4(0, rl.y, 0, 0), rl.x));
+        auto rl = Precision::Vector2<Scalar>(width, height);
+        auto Levels = EstimateDetailLevels(height, 1 / .7, depth - 1);
+        auto [CoarseLevels, FineLevels] = std::tuple{ static_cast<int>(std::floor(Levels)), static_cast<int>(std::ceil(Levels)) };
+        auto CoarseDistance = l;
+        auto leaf = 0;
+        for (int i = 1; i <= FineLevels; i++) {
+            if (auto d = ln(pos, Precision::Vector4<Scalar>(0), Precision::Vector4<Scalar>(0, rl.y, 0, 0), rl.x); d < l)
+                l = d, leaf = 0;
             pos.y -= rl.y;
-            pos.x = abs(pos.x);
-            auto tmp = glm::vec2{ pos.x,pos.y } *ro(rxy);
+            pos.x = std::abs(pos.x);
+            auto tmp = Precision::Vector2<Scalar>{ pos.x,pos.y } *ro(sxy, cxy);
             pos.x = tmp.x;
             pos.y = tmp.y;
-            tmp = glm::vec2{ pos.z,pos.x }*ro(rzx);
+            tmp = Precision::Vector2<Scalar>{ pos.z,pos.x }*ro(szx, czx);
             pos.z = tmp.x;
             pos.x = tmp.y;
 
-            rl *= (.7 + 0.015 * float(i));
-
-            //            if( glm::length(pos)-0.15*sqrt(rl.x) <l && i> settings.fractalDepth - 4){
-            //                leaf=1;
-            //            }
+            rl *= static_cast<Scalar>(.7 + 0.015 * i);
 
-            l = std::min(l, glm::length(pos) - 0.15 * sqrt(rl.x));
+            if (auto d = glm::length(pos) - static_cast<Scalar>(0.15) * std::sqrt(rl.x); d < l)
+                l = d, leaf = 1;
+            if (i == CoarseLevels)
+                CoarseDistance = l;
         }
-        return l;
+        DistanceField::Auxiliary.SubObject = leaf;
+        if (CoarseLevels == FineLevels)
+            return l;
+        return CoarseDistance + static_cast<Scalar>(Levels - CoarseLevels) * (l - CoarseDistance);
 
     };
 